@@ -1,534 +1,4556 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <map>
-#include <unordered_map>
-#include <queue>
-#include <algorithm>
-#include <random>
-#include <cmath>
-#include <chrono>
-#include <thread>
-#include <stack>
-#include <set>
-#include <iomanip>
-#include <climits>
-#include <unordered_set>
-
-using namespace std;
-
-class Graph {
-private:
-    unordered_map<string, unordered_map<string, int>> adjList;
-    unordered_map<string, double> pageRank;
-    unordered_map<string, unordered_map<string, vector<string>>> bridgeCache;
-
-public:
-    void addEdge(const string& src, const string& dest) {
-        adjList[src][dest]++;
-    }
-
-    auto getAdjList() const -> const unordered_map<string, unordered_map<string, int>>& {
-        return adjList;
-    }
-
-    auto getBridgeWords(const string& word1, const string& word2) -> vector<string> {
-        bool word1Exists = adjList.count(word1) != 0u;
-        bool word2Exists = adjList.count(word2) != 0u;
-        
-        // 检查单词是否在图中，并给出具体的错误信息
-        if (!word1Exists || !word2Exists) {
-            string errorMsg;
-            if (!word1Exists && !word2Exists) {
-                errorMsg = "No \"" + word1 + "\" and \"" + word2 + "\" in the graph!";
-            } else if (!word1Exists) {
-                errorMsg = "No \"" + word1 + "\" in the graph!";
-            } else {
-                errorMsg = "No \"" + word2 + "\" in the graph!";
-            }
-            return {errorMsg};
-        }
-        
-        vector<string> bridges;
-        for (auto& [mid, _] : adjList[word1]) {
-            if (adjList[mid].count(word2) != 0u) {
-                bridges.push_back(mid);
-            }
-        }
-        
-        // 如果没有找到桥接词，返回特殊消息
-        if (bridges.empty()) {
-            return {"No bridge words from \"" + word1 + "\" to \"" + word2 + "\"!"};
-        }
-        
-        return bridges;
-    }
-
-    auto shortestPath(const string& src, const string& dest) -> vector<string> {
-        priority_queue<pair<int, string>, vector<pair<int, string>>, greater<>> pq;
-        unordered_map<string, int> dist;
-        unordered_map<string, string> prev;
-
-    for (const auto& entry : adjList) {  // 放弃结构化绑定
-        const auto& node = entry.first;  // 明确初始化变量
-        dist[node] = INT_MAX;
-    }
-        dist[src] = 0;
-        pq.emplace(0, src);
-
-        while (!pq.empty()) {
-            auto [d, u] = pq.top(); pq.pop();
-            if (u == dest) { break;
-}
-            for (auto& [v, w] : adjList[u]) {
-                if (dist[v] > dist[u] + w) {
-                    dist[v] = dist[u] + w;
-                    prev[v] = u;
-                    pq.emplace(dist[v], v);
-                }
-            }
-        }
-
-        vector<string> path;
-        if (dist[dest] == INT_MAX) { return path;
-}
-        for (string cur = dest; cur != src; cur = prev[cur]) {
-            path.push_back(cur);
-        }
-        path.push_back(src);
-        reverse(path.begin(), path.end());
-        return path;
-    }
-
-    void calculatePageRank(double damping = 0.85, int iterations = 100) {
-        // Step 1: 收集所有节点（包括源节点和目标节点）
-        unordered_set<string> allNodes;
-        for (const auto& [src, edges] : adjList) {
-            allNodes.insert(src);
-            for (const auto& [dest, _] : edges) {
-                allNodes.insert(dest);
-            }
-        }
-        const double N = allNodes.size();
-        
-        // Step 2: 初始化PR值为 1/N
-        unordered_map<string, double> pr;
-        for (const auto& node : allNodes) {
-            pr[node] = 1.0 / N;
-        }
-    
-        // Step 3: 迭代计算
-        for (int i = 0; i < iterations; ++i) {
-            unordered_map<string, double> newPr;
-    
-            // 计算悬挂节点的PR总和（出度为0的节点）
-            double danglingSum = 0.0;
-            for (const auto& node : allNodes) {
-                // 判断节点是否有出边：不在 adjList 中，或 adjList 中的出边为空
-                if (adjList.find(node) == adjList.end() || adjList.at(node).empty()) {
-                    danglingSum += pr[node];
-                }
-            }
-    
-            // 计算每个节点的新PR值
-            for (const auto& node : allNodes) {
-                double sumIn = 0.0;
-                // 遍历所有可能的入边来源节点
-                for (const auto& entry : adjList) {
-                    const auto& src = entry.first;    // 显式初始化
-                    const auto& edges = entry.second; // 显式初始化
-                    // 使用 src 和 edges
-                    if (edges.count(node) != 0u) { // 如果 src 指向当前节点
-                        sumIn += pr[src] / edges.size(); // 贡献为 PR(src)/出度
-                    }
-                }
-
-                // 计算新PR值（包含阻尼因子和悬挂节点均分）
-                newPr[node] = (1.0 - damping) / N + damping * (sumIn + danglingSum / N);
-            }
-    
-            pr = newPr; // 更新PR值
-        }
-    
-        // 保存结果到成员变量
-        pageRank.clear();
-        for (const auto& node : allNodes) {
-            pageRank[node] = pr[node];
-        }
-    }
-
-    auto getPageRank(const string& word) -> double {
-        return pageRank.count(word) != 0u ? pageRank[word] : 0.0;
-    }
-
-    auto randomWalk() -> string {
-        if (adjList.empty()) { return "";
-}
-        vector<string> nodes;
-        for (auto& [node, _] : adjList) { nodes.push_back(node);
-}
-        static random_device rd;
-        static mt19937 gen(rd());
-        uniform_int_distribution<> dis(0, nodes.size()-1);
-        
-        string current = nodes[dis(gen)];
-        set<pair<string, string>> visitedEdges;
-        vector<string> path;
-        path.push_back(current);
-
-        while (true) {
-            auto& edges = adjList[current];
-            if (edges.empty()) { break;
-}
-            
-            vector<string> targets;
-            for (auto& [t, _] : edges) { targets.push_back(t);
-}
-            uniform_int_distribution<> edgeDis(0, targets.size()-1);
-            string next = targets[edgeDis(gen)];
-            
-            if (visitedEdges.count({current, next}) != 0u) { break;
-}
-            visitedEdges.insert({current, next});
-            current = next;
-            path.push_back(current);
-        }
-
-        stringstream ss;
-        for (auto& word : path) { ss << word << " ";
-}
-        
-        // 将结果保存到文件
-        ofstream outFile("random_walk.txt");
-        outFile << ss.str();
-        outFile.close();
-        
-        return ss.str();
-    }
-};
-
-class TextProcessor {
-public:
-    static auto processText(const string& filename) -> vector<string> {
-        ifstream file(filename);
-        string text;
-        string line;
-        while (getline(file, line)) {
-            text += line + " ";
-        }
-
-        string processed;
-        for (char c : text) {
-            if (isalpha(c) != 0) { processed += tolower(c);
-            } else { processed += ' ';
-}
-        }
-
-        stringstream ss(processed);
-        vector<string> words;
-        string word;
-        while (ss >> word) {
-            words.push_back(word);
-        }
-        return words;
-    }
-};
-
-void exportToDot(const Graph& graph, const string& filename = "graph.dot", 
-                const vector<string>& highlightPath = vector<string>()) {
-    ofstream dotFile(filename);
-    dotFile << "digraph G {\n";
-    dotFile << "  rankdir=LR;\n";  // 设置从左到右的布局
-
-    // 创建用于检查边是否在最短路径上的辅助函数
-    auto isEdgeInPath = [&](const string& src, const string& dest) {
-        if (highlightPath.empty()) { return false;
-}
-        for (size_t i = 0; i < highlightPath.size() - 1; ++i) {
-            if (highlightPath[i] == src && highlightPath[i + 1] == dest) {
-                return true;
-            }
-        }
-        return false;
-    };
-
-    const auto& adjList = graph.getAdjList();
-    for (const auto& [src, edges] : adjList) {
-        for (const auto& [dest, weight] : edges) {
-            dotFile << "  \"" << src << "\" -> \"" << dest << "\" [";
-            // 如果边在最短路径上，则用红色标注
-            if (isEdgeInPath(src, dest)) {
-                dotFile << "color=red, penwidth=2.0, ";
-            }
-            dotFile << "label=\"" << weight << "\"];\n";
-        }
-    }
-    dotFile << "}\n";
-    dotFile.close();
-}
-
-// 更新showDirectedGraph函数，添加导出选项
-void showDirectedGraph(const Graph& graph, bool exportImage = false) {
-    // 原有命令行展示逻辑
-    const auto& adjList = graph.getAdjList();
-    cout << "Directed Graph:\n";
-    for (const auto& entry : adjList) {
-        const auto& src = entry.first;
-        const auto& edges = entry.second;
-        // ...
-        cout << src << " -> ";
-        for (const auto& edge : edges) {
-            const auto& dest = edge.first;
-            const auto& weight = edge.second;
-            // ...
-            cout << dest << "(" << weight << ") ";
-        }
-
-        cout << "\n";
-    }
-
-
-    // 导出为图像文件（可选功能）
-    if (exportImage) {
-        exportToDot(graph);
-        (void)system("dot -Tpng graph.dot -o graph.png");
-        cout << "\nGraph image saved to graph.png\n";
-    }
-}
-
-auto queryBridgeWords(Graph& graph, const string& word1, const string& word2) -> string {
-    auto bridges = graph.getBridgeWords(word1, word2);
-    
-    // 如果是错误消息，直接返回
-    if (!bridges.empty() && (bridges[0].find("No \"") != string::npos || 
-        bridges[0].find("No bridge words") != string::npos)) {
-        return bridges[0];
-    }
-    
-    stringstream ss;
-    ss << "The bridge words from \"" << word1 << "\" to \"" << word2 << "\" are: ";
-    for (size_t i = 0; i < bridges.size(); ++i) {
-        if (i == bridges.size() - 1) {
-            ss << "and \"" << bridges[i] << "\".";
-        } else if (i == bridges.size() - 2) {
-            ss << "\"" << bridges[i] << "\" ";
-        } else {
-            ss << "\"" << bridges[i] << "\", ";
-        }
-    }
-    return ss.str();
-}
-
-auto generateNewText(Graph& graph, const string& input) -> string {
-    vector<string> words;
-    stringstream ss(input);
-    string word;
-    while (ss >> word) {
-        transform(word.begin(), word.end(), word.begin(), ::tolower);
-        words.push_back(word);
-    }
-
-    vector<string> newText;
-    random_device rd;
-    mt19937 gen(rd());
-    
-    for (size_t i = 0; i < words.size(); ++i) {
-        newText.push_back(words[i]);
-        if (i < words.size() - 1) {
-            auto bridges = graph.getBridgeWords(words[i], words[i+1]);
-            // 只在找到有效的桥接词时才添加（排除所有错误消息的情况）
-            if (!bridges.empty() && bridges[0].find("No ") == string::npos) {
-                uniform_int_distribution<> dis(0, bridges.size()-1);
-                newText.push_back(bridges[dis(gen)]);
-            }
-        }
-    }
-
-    stringstream result;
-    for (size_t i = 0; i < newText.size(); ++i) {
-        if (i > 0) { result << " ";
-}
-        result << newText[i];
-    }
-    return result.str();
-}
-
-auto calcShortestPath(Graph& graph, const string& word1, const string& word2) -> string {
-    auto path = graph.shortestPath(word1, word2);
-    if (path.empty()) { return "No path from " + word1 + " to " + word2 + "!";
-}
-    
-    // 导出带有红色标注的路径图
-    exportToDot(graph, "graph.dot", path);
-    system("dot -Tpng graph.dot -o graph.png");
-    
-    stringstream ss;
-    ss << "Shortest path: ";
-    for (size_t i = 0; i < path.size(); ++i) {
-        if (i > 0) { ss << " -> ";
-}
-        ss << path[i];
-    }
-    ss << "\nGraph with highlighted path has been saved to graph.png";
-    return ss.str();
-}
-
-// 修改计算单源最短路径的函数
-auto calcShortestPathToAll(Graph& graph, const string& source) -> string {
-    const auto& adjList = graph.getAdjList();
-    if (adjList.count(source) == 0u) {
-        return "输入的单词 '" + source + "' 不在图中！";
-    }
-
-    stringstream result;
-    result << "从单词 '" << source << "' 到其他所有单词的最短路径：\n";
-    
-    vector<string> destinations;
-    for (const auto& [dest, _] : adjList) {
-        if (dest != source) {
-            destinations.push_back(dest);
-        }
-    }
-    sort(destinations.begin(), destinations.end());
-
-    for (const string& dest : destinations) {
-        auto path = graph.shortestPath(source, dest);
-        result << "\n到 '" << dest << "' 的最短路径: ";
-        if (path.empty()) {
-            result << "不存在路径";
-        } else {
-            // 为每个路径生成单独的图片
-            std::string dotFile("path_");
-            dotFile.reserve(32);  // 预分配合理空间（按实际需要调整）
-            dotFile.append(source)
-                   .append("_to_")
-                   .append(dest)
-                   .append(".dot");
-            std::string pngFile("path_");
-            pngFile.reserve(32);  // 预分配合理空间
-            pngFile.append(source)
-                   .append("_to_")
-                   .append(dest)
-                   .append(".png"); 
-            exportToDot(graph, dotFile, path);
-            std::string cmd("dot -Tpng ");
-            cmd.reserve(128);  // 预分配合理空间
-            cmd.append(dotFile)
-               .append(" -o ")
-               .append(pngFile);
-            system(cmd.c_str());
-            
-            for (size_t i = 0; i < path.size(); ++i) {
-                if (i > 0) { result << " -> ";
-}
-                result << path[i];
-            }
-            result << " (查看 " << pngFile << ")";
-        }
-    }
-    
-    return result.str();
-}
-
-auto calcPageRank(Graph& graph, const string& word) -> double {
-    return graph.getPageRank(word);
-}
-
-auto randomWalk(Graph& graph) -> string {
-    return graph.randomWalk();
-}
-
-auto main(int argc, char* argv[]) -> int {
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <filename>\n";
-        return 1;
-    }
-
-    auto words = TextProcessor::processText(argv[1]);
-    Graph graph;
-    for (size_t i = 0; i < words.size()-1; ++i) {
-        graph.addEdge(words[i], words[i+1]);
-    }
-
-    graph.calculatePageRank();
-
-    while (true) {
-        cout << "\nOptions:\n"
-             << "1. Show directed graph\n"
-             << "2. Export graph to image (PNG)\n"
-             << "3. Query bridge words\n"
-             << "4. Generate new text\n"
-             << "5. Calculate shortest path\n"
-             << "6. Calculate PageRank\n"
-             << "7. Random walk\n"
-             << "8. Exit\n"
-             << "Choice: ";
-
-        int choice;
-        cin >> choice;
-        cin.ignore();
-
-        switch (choice) {
-            case 1:
-                showDirectedGraph(graph);
-                break;
-            case 2:
-                showDirectedGraph(graph, true);  // 导出为图像
-                break;
-            case 3: {
-                string word1;
-                string word2;
-                cout << "Enter two words: ";
-                cin >> word1 >> word2;
-                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
-                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
-                cout << queryBridgeWords(graph, word1, word2) << endl;
-                break;
-            }
-            case 4: {
-                string input;
-                cout << "Enter text: ";
-                getline(cin, input);
-                cout << generateNewText(graph, input) << endl;
-                break;
-            }
-            case 5: {
-                string word1;
-                string word2;
-                cout << "Enter one or two words: ";
-                cin >> word1;
-                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
-                
-                // 检查是否有第二个单词输入
-                string line;
-                getline(cin, line);
-                stringstream ss(line);
-                if (ss >> word2) {
-                    // 如果输入了两个单词，计算它们之间的最短路径
-                    transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
-                    cout << calcShortestPath(graph, word1, word2) << endl;
-                } else {
-                    // 如果只输入了一个单词，计算到所有其他单词的最短路径
-                    cout << calcShortestPathToAll(graph, word1) << endl;
-                }
-                break;
-            }
-            case 6: {
-                string word;
-                cout << "Enter word: ";
-                cin >> word;
-                transform(word.begin(), word.end(), word.begin(), ::tolower);
-                cout << "PageRank: " << fixed << setprecision(4) << calcPageRank(graph, word) << endl;
-                break;
-            }
-            case 7:
-                cout << "Random walk: " << randomWalk(graph) << endl;
-                break;
-            case 8:
-                return 0;
-            default:
-                cout << "Invalid choice\n";
-        }
-    }
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <queue>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <stack>
+#include <set>
+#include <iomanip>
+#include <climits>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <array>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <string_view>
+#include <cstdint>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// 只读内存映射文件：语料按页由内核换入换出，不需要整份读进堆内存
+class MappedFile {
+public:
+    explicit MappedFile(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) { return;
+}
+        struct stat st{};
+        if (::fstat(fd, &st) == 0) {
+            opened = true;
+            length = static_cast<size_t>(st.st_size);
+            if (length > 0) {
+                void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) {
+                    opened = false;
+                    length = 0;
+                } else {
+                    base = static_cast<const char*>(addr);
+                    ::madvise(addr, length, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (base != nullptr) { ::munmap(const_cast<char*>(base), length);
+}
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    // 调整内核的预读策略，例如随机访问的快照用 MADV_RANDOM
+    void advise(int advice) const {
+        if (base != nullptr) { ::madvise(const_cast<char*>(base), length, advice);
+}
+    }
+
+    auto isOpen() const -> bool { return opened; }
+    auto data() const -> const char* { return base; }
+    auto size() const -> size_t { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    bool opened = false;
+};
+
+// 只读数组：要么持有自己的 vector，要么直接指向外部内存（例如映射进来的快照文件，由持有映射的一方保证其存活）。
+// CSR 的各个数组用它保存，从快照加载时不必把数据复制到堆上，同一主机上的多个进程共享同一份页缓存
+template <class T>
+class ReadOnlyArray {
+public:
+    ReadOnlyArray() = default;
+    ReadOnlyArray(vector<T> values) : owned(move(values)), first(owned.data()), count(owned.size()) {}
+    ReadOnlyArray(const T* data, size_t size) : first(data), count(size), viewing(true) {}
+
+    ReadOnlyArray(const ReadOnlyArray& other) : owned(other.owned), count(other.count), viewing(other.viewing) {
+        first = viewing ? other.first : owned.data();
+    }
+
+    ReadOnlyArray(ReadOnlyArray&& other) noexcept
+        : owned(move(other.owned)), count(other.count), viewing(other.viewing) {
+        first = viewing ? other.first : owned.data();
+    }
+
+    auto operator=(ReadOnlyArray other) noexcept -> ReadOnlyArray& {
+        owned = move(other.owned);
+        count = other.count;
+        viewing = other.viewing;
+        first = viewing ? other.first : owned.data();
+        return *this;
+    }
+
+    ~ReadOnlyArray() = default;
+
+    auto operator[](size_t i) const -> const T& { return first[i]; }
+    auto data() const -> const T* { return first; }
+    auto size() const -> size_t { return count; }
+    auto empty() const -> bool { return count == 0; }
+    auto begin() const -> const T* { return first; }
+    auto end() const -> const T* { return first + count; }
+
+private:
+    vector<T> owned;
+    const T* first = nullptr;
+    size_t count = 0;
+    bool viewing = false;
+};
+
+// 启动 threads 个线程并行执行 task(t)，t 为线程序号；全部结束后返回。threads <= 1 时直接在当前线程执行
+template <class Task>
+void runThreads(unsigned threads, Task&& task) {
+    if (threads <= 1) {
+        task(0u);
+        return;
+    }
+    vector<thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&task, t] { task(t); });
+    }
+    for (auto& worker : workers) { worker.join();
+}
+}
+
+// 可重复使用的线程屏障（C++17 还没有 std::barrier）：count 个线程都到达后一起放行
+class Barrier {
+public:
+    explicit Barrier(unsigned count) : count(count) {}
+
+    void arriveAndWait() {
+        unique_lock<mutex> lock(mtx);
+        size_t current = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [&] { return generation != current; });
+    }
+
+private:
+    const unsigned count;
+    unsigned arrived = 0;
+    size_t generation = 0;
+    mutex mtx;
+    condition_variable released;
+};
+
+// SplitMix64：只有 64 位状态的随机数发生器，构造几乎没有开销，适合给每条输入、每次游走单独播种
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    auto next() -> uint64_t {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1) 内的均匀浮点数（取高 53 位）
+    auto uniform() -> double {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // [0, n) 内的均匀整数（乘法取高位，避免取模）
+    auto below(uint64_t n) -> uint64_t {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+};
+
+// 按序号顺序输出的写入器：各线程乱序提交 (index, text)，前面的序号都写出后才依次落盘，
+// 内存里只暂存乱序窗口内的结果
+class OrderedWriter {
+public:
+    explicit OrderedWriter(ostream& out) : out(out) {}
+
+    void submit(size_t index, string text) {
+        lock_guard<mutex> lock(mtx);
+        if (index != next) {
+            pending.emplace(index, move(text));
+            return;
+        }
+        out << text;
+        next++;
+        for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+            out << it->second;
+            pending.erase(it);
+            next++;
+        }
+    }
+
+private:
+    ostream& out;
+    mutex mtx;
+    size_t next = 0;
+    unordered_map<size_t, string> pending;
+};
+
+// 单词驻留表：把单词映射为稠密的 uint32 编号，编号按首次出现顺序分配
+class WordInterner {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    auto intern(string_view word) -> uint32_t {
+        uint32_t found = find(word);
+        if (found != npos) { return found;
+}
+        storage.emplace_back(word);
+        string_view stored = storage.back();
+        auto id = static_cast<uint32_t>(size());
+        words.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    auto find(string_view word) const -> uint32_t {
+        if (!baseIndex.empty()) {
+            const size_t mask = baseIndex.size() - 1;
+            for (size_t i = hashWord(word) & mask; baseIndex[i] != npos; i = (i + 1) & mask) {
+                if (baseWord(baseIndex[i]) == word) { return baseIndex[i];
+}
+            }
+        }
+        auto it = ids.find(word);
+        return it != ids.end() ? it->second : npos;
+    }
+
+    auto word(uint32_t id) const -> string_view {
+        return id < baseCount ? baseWord(id) : words[id - baseCount];
+    }
+
+    auto size() const -> size_t {
+        return baseCount + words.size();
+    }
+
+    // 把外部词表（通常映射自快照文件）作为前 offsets.size() - 1 个单词，不复制：第 i 个单词是
+    // blob[offsets[i], offsets[i+1])，index 是 lookupTable() 格式的查找表。只能在空的驻留表上调用，之后仍可继续 intern
+    void attach(const char* blob, ReadOnlyArray<uint64_t> offsets, ReadOnlyArray<uint32_t> index) {
+        baseBlob = blob;
+        baseOffsets = move(offsets);
+        baseIndex = move(index);
+        baseCount = baseOffsets.empty() ? 0 : baseOffsets.size() - 1;
+    }
+
+    // 按 hashWord 线性探测的开放寻址表，槽位数为 2 的幂且不少于单词数的两倍，空槽为 npos。
+    // 写进快照后，加载方直接在映射的表上查找，不必逐词重建哈希表
+    auto lookupTable() const -> vector<uint32_t> {
+        size_t slots = 1;
+        while (slots < size() * 2) { slots <<= 1;
+}
+        vector<uint32_t> table(slots, npos);
+        for (uint32_t id = 0; id < size(); ++id) {
+            size_t i = hashWord(word(id)) & (slots - 1);
+            while (table[i] != npos) { i = (i + 1) & (slots - 1);
+}
+            table[i] = id;
+        }
+        return table;
+    }
+
+    // FNV-1a：结果写进快照文件，所以不能用各实现不同的 std::hash
+    static auto hashWord(string_view word) -> uint64_t {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : word) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+private:
+    auto baseWord(uint32_t id) const -> string_view {
+        return {baseBlob + baseOffsets[id], static_cast<size_t>(baseOffsets[id + 1] - baseOffsets[id])};
+    }
+
+    // attach 进来的单词占据编号 [0, baseCount)，之后 intern 的单词接在后面
+    const char* baseBlob = nullptr;
+    ReadOnlyArray<uint64_t> baseOffsets;
+    ReadOnlyArray<uint32_t> baseIndex;
+    size_t baseCount = 0;
+    deque<string> storage;                    // deque 保证元素地址稳定，string_view 不会失效
+    vector<string_view> words;
+    unordered_map<string_view, uint32_t> ids;
+};
+
+// 冻结后的压缩稀疏行（CSR）邻接表：offsets[u]..offsets[u+1] 是 u 的出边，targets 按编号升序
+struct CsrGraph {
+    ReadOnlyArray<uint64_t> offsets{vector<uint64_t>{0}};
+    ReadOnlyArray<uint32_t> targets;
+    ReadOnlyArray<int> weights;
+    // 反向索引：inOffsets[v]..inOffsets[v+1] 是指向 v 的边，inSources 按编号升序
+    ReadOnlyArray<uint64_t> inOffsets{vector<uint64_t>{0}};
+    ReadOnlyArray<uint32_t> inSources;
+    ReadOnlyArray<int> inWeights;
+    int maxWeight = 0;                   // 最大边权，Dial 桶队列按它分配桶
+
+    auto vertexCount() const -> size_t { return offsets.size() - 1; }
+    auto edgeCount() const -> size_t { return targets.size(); }
+    auto outDegree(uint32_t u) const -> size_t { return offsets[u + 1] - offsets[u]; }
+    auto inDegree(uint32_t v) const -> size_t { return inOffsets[v + 1] - inOffsets[v]; }
+
+    // 在有序的出边中二分查找 u->v，返回边下标，不存在时返回 edgeCount()
+    auto findEdge(uint32_t u, uint32_t v) const -> size_t {
+        auto first = targets.begin() + static_cast<ptrdiff_t>(offsets[u]);
+        auto last = targets.begin() + static_cast<ptrdiff_t>(offsets[u + 1]);
+        auto it = lower_bound(first, last, v);
+        return (it != last && *it == v) ? static_cast<size_t>(it - targets.begin()) : edgeCount();
+    }
+};
+
+// 有序列表求交，结果追加到 out。长度相近时线性归并；相差悬殊时对短列表的每个元素
+// 在长列表里做倍增（galloping）查找，代价为 O(短 × log(长/短))
+inline void intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, vector<uint32_t>& out) {
+    if (na > nb) {
+        swap(a, b);
+        swap(na, nb);
+    }
+    if (na == 0) { return;
+}
+    if (nb / na < 16) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i < na && j < nb) {
+            if (a[i] < b[j]) { ++i;
+            } else if (b[j] < a[i]) { ++j;
+            } else {
+                out.push_back(a[i]);
+                ++i;
+                ++j;
+            }
+        }
+        return;
+    }
+    size_t low = 0;
+    for (size_t i = 0; i < na && low < nb; ++i) {
+        // 从上次的位置开始按 1, 2, 4, ... 步长向后探测，再在最后一段里二分
+        size_t step = 1;
+        size_t high = low;
+        while (high < nb && b[high] < a[i]) {
+            low = high + 1;
+            high += step;
+            step <<= 1;
+        }
+        const uint32_t* it = lower_bound(b + low, b + min(high + 1, nb), a[i]);
+        low = static_cast<size_t>(it - b);
+        if (low < nb && b[low] == a[i]) { out.push_back(a[i]);
+}
+    }
+}
+
+// 单源最短路径树：dist[v] 为源点到 v 的距离（不可达为 INT_MAX），prev[v] 为最短路径上 v 的前驱
+struct ShortestPathTree {
+    uint32_t source = UINT32_MAX;
+    vector<int> dist;
+    vector<uint32_t> prev;
+
+    auto reachable(uint32_t v) const -> bool { return v < dist.size() && dist[v] != INT_MAX; }
+
+    // 沿前驱回溯出 source -> v 的路径，不可达时返回空
+    auto pathTo(uint32_t v) const -> vector<uint32_t> {
+        vector<uint32_t> path;
+        if (!reachable(v)) { return path;
+}
+        for (uint32_t cur = v; cur != source; cur = prev[cur]) {
+            path.push_back(cur);
+        }
+        path.push_back(source);
+        reverse(path.begin(), path.end());
+        return path;
+    }
+};
+
+// PageRank 迭代方式：Jacobi 即经典的幂迭代；GaussSeidel 在同一轮内立即使用已经更新过的节点值，通常收敛更快
+enum class PageRankMethod { Jacobi, GaussSeidel };
+
+struct PageRankOptions {
+    double damping = 0.85;
+    int maxIterations = 100;
+    double tolerance = 0.0;      // 相邻两轮 PR 向量的 L1 残差低于该值即停止，0 表示固定跑满 maxIterations
+    PageRankMethod method = PageRankMethod::Jacobi;
+    int aitkenEvery = 0;         // Jacobi 下每隔多少轮做一次 Aitken Δ² 外推，0 表示不外推
+    bool warmStart = false;      // 从上一次的结果出发（图有少量新增边时只需很少几轮）
+    unsigned threads = 1;        // 并行计算的线程数（Gauss-Seidel 总是单线程）
+};
+
+// PageRank 结果的状态：还没有计算、正在后台计算、可用、addEdge 之后已经过期
+enum class PageRankStatus { NotComputed, Computing, Ready, Stale };
+
+// 最近一次 PageRank 计算的收敛情况
+struct PageRankStats {
+    int iterations = 0;
+    bool converged = false;
+    vector<double> residuals;    // 每一轮的 L1 残差
+};
+
+inline auto edgeKey(uint32_t src, uint32_t dest) -> uint64_t {
+    return (static_cast<uint64_t>(src) << 32) | dest;
+}
+
+// Dijkstra 的优先队列。边权是正整数，出队的键单调不减，所以除了二叉堆还可以用整数桶结构；
+// 搜索函数以模板参数选择队列，三者接口相同：reset / empty / push / top / pop
+
+// 普通二叉堆，O(log n) 的入队出队，对键没有要求
+class BinaryHeapQueue {
+public:
+    void reset(int /*maxWeight*/) { heap.clear(); }
+    auto empty() const -> bool { return heap.empty(); }
+
+    void push(int key, uint32_t v) {
+        heap.emplace_back(key, v);
+        push_heap(heap.begin(), heap.end(), greater<>());
+    }
+
+    auto top() -> int { return heap.front().first; }
+
+    auto pop() -> pair<int, uint32_t> {
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        auto item = heap.back();
+        heap.pop_back();
+        return item;
+    }
+
+private:
+    vector<pair<int, uint32_t>> heap;
+};
+
+// Dial 桶队列：maxWeight + 1 个循环桶，队列中的键总在 [当前最小键, 当前最小键 + maxWeight] 内，
+// 所以桶号 key % 桶数 唯一对应一个键。入队 O(1)，出队时顺序扫描空桶，适合最大边权较小的图
+class DialQueue {
+public:
+    void reset(int maxWeight) {
+        if (buckets.size() != static_cast<size_t>(maxWeight) + 1) {
+            buckets.assign(static_cast<size_t>(maxWeight) + 1, {});
+        } else if (count != 0) {
+            for (auto& bucket : buckets) { bucket.clear();
+}
+        }
+        current = 0;
+        count = 0;
+    }
+
+    auto empty() const -> bool { return count == 0; }
+
+    void push(int key, uint32_t v) {
+        buckets[static_cast<size_t>(key) % buckets.size()].emplace_back(key, v);
+        count++;
+    }
+
+    auto top() -> int {
+        while (buckets[static_cast<size_t>(current) % buckets.size()].empty()) { current++;
+}
+        return current;
+    }
+
+    auto pop() -> pair<int, uint32_t> {
+        auto& bucket = buckets[static_cast<size_t>(top()) % buckets.size()];
+        auto item = bucket.back();
+        bucket.pop_back();
+        count--;
+        return item;
+    }
+
+private:
+    vector<vector<pair<int, uint32_t>>> buckets;
+    int current = 0;
+    size_t count = 0;
+};
+
+// 基数堆（radix heap）：第 i 个桶存放与上次出队键 last 的最高不同位为第 i 位的元素。
+// 0 号桶为空时，把第一个非空桶里的元素按新的 last 重新分桶；每个元素最多下沉 32 次，
+// 与边权大小无关
+class RadixHeapQueue {
+public:
+    void reset(int /*maxWeight*/) {
+        for (auto& bucket : buckets) { bucket.clear();
+}
+        last = 0;
+        count = 0;
+    }
+
+    auto empty() const -> bool { return count == 0; }
+
+    void push(int key, uint32_t v) {
+        buckets[bucketOf(key)].emplace_back(key, v);
+        count++;
+    }
+
+    auto top() -> int {
+        settle();
+        return last;
+    }
+
+    auto pop() -> pair<int, uint32_t> {
+        settle();
+        auto item = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return item;
+    }
+
+private:
+    auto bucketOf(int key) const -> size_t {
+        auto diff = static_cast<uint32_t>(key) ^ static_cast<uint32_t>(last);
+        return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    void settle() {
+        if (!buckets[0].empty()) { return;
+}
+        size_t i = 1;
+        while (buckets[i].empty()) { ++i;
+}
+        last = min_element(buckets[i].begin(), buckets[i].end())->first;
+        for (const auto& item : buckets[i]) {
+            buckets[bucketOf(item.first)].push_back(item);
+        }
+        buckets[i].clear();
+    }
+
+    array<vector<pair<int, uint32_t>>, 33> buckets;
+    int last = 0;
+    size_t count = 0;
+};
+
+// 默认使用的队列（按 --bench-sssp 在实际语料上的结果选择）
+using PathQueue = RadixHeapQueue;
+
+// 单源 Dijkstra，求出从 s 出发的完整最短路径树。backward 为 true 时沿反向索引搜索，
+// 此时 dist[v] 是 v 到 s 的距离，prev[v] 是 v 在这条路径上的后继
+// 多次调用时传入同一个 queue 与 tree 即可复用它们的内存
+template <class Queue>
+void runDijkstra(const CsrGraph& g, uint32_t s, ShortestPathTree& tree, bool backward, Queue& queue) {
+    const auto& offsets = backward ? g.inOffsets : g.offsets;
+    const auto& neighbors = backward ? g.inSources : g.targets;
+    const auto& weights = backward ? g.inWeights : g.weights;
+    queue.reset(g.maxWeight);
+    tree.source = s;
+    tree.dist.assign(g.vertexCount(), INT_MAX);
+    tree.prev.assign(g.vertexCount(), WordInterner::npos);
+    auto& dist = tree.dist;
+    dist[s] = 0;
+    queue.push(0, s);
+
+    while (!queue.empty()) {
+        auto [d, u] = queue.pop();
+        if (d > dist[u]) { continue;
+}
+        for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            uint32_t v = neighbors[e];
+            if (dist[v] > d + weights[e]) {
+                dist[v] = d + weights[e];
+                tree.prev[v] = u;
+                queue.push(dist[v], v);
+            }
+        }
+    }
+}
+
+template <class Queue = PathQueue>
+void runDijkstra(const CsrGraph& g, uint32_t s, ShortestPathTree& tree, bool backward = false) {
+    Queue queue;
+    runDijkstra(g, s, tree, backward, queue);
+}
+
+// 点对点最短路径搜索的统计：出队定点的节点数、松弛的边数与找到的路径长度（不可达为 -1）
+struct PathSearchStats {
+    size_t settled = 0;
+    size_t relaxed = 0;
+    int64_t length = -1;
+};
+
+// 双向搜索一侧的工作区，在多次查询之间复用。dist/parent 只在 stamp[v] 等于当前查询编号时有效，
+// 每次查询只会初始化真正访问到的节点，而不是整张图
+template <class Queue>
+struct SearchFrontier {
+    vector<int> dist;
+    vector<uint32_t> parent;                 // 正向一侧是前驱，反向一侧是后继
+    vector<uint32_t> stamp;
+    Queue queue;
+
+    void prepare(size_t vertexCount, int maxWeight) {
+        if (stamp.size() < vertexCount) {
+            dist.resize(vertexCount);
+            parent.resize(vertexCount);
+            stamp.resize(vertexCount, 0);
+        }
+        queue.reset(maxWeight);
+    }
+
+    auto distance(uint32_t v, uint32_t query) const -> int {
+        return stamp[v] == query ? dist[v] : INT_MAX;
+    }
+
+    void reach(uint32_t v, int d, uint32_t from, uint32_t query) {
+        reach(v, d, from, query, d);
+    }
+
+    // priority 是入队的键：Dijkstra 用距离本身，A* 用距离加下界
+    void reach(uint32_t v, int d, uint32_t from, uint32_t query, int priority) {
+        stamp[v] = query;
+        dist[v] = d;
+        parent[v] = from;
+        queue.push(priority, v);
+    }
+};
+
+// 双向 Dijkstra：正向沿出边、反向沿反向索引交替扩展堆顶距离较小的一侧。
+// 松弛到另一侧已经到达的节点时更新经过该点的路径长度 best；两侧堆顶之和不小于 best 时，
+// 不可能再有更短的路径，即可停止
+template <class Queue = PathQueue>
+class BidirectionalDijkstra {
+public:
+    // 返回 s -> t 的节点序列，不可达时为空
+    auto search(const CsrGraph& g, uint32_t s, uint32_t t) -> vector<uint32_t> {
+        return search(g, s, t, [](uint32_t, uint32_t) { return true; });
+    }
+
+    // 只走 allow(u, v) 为 true 的边 u -> v（按原图方向），供 k 短路求支路时删点删边
+    template <class EdgeFilter>
+    auto search(const CsrGraph& g, uint32_t s, uint32_t t, EdgeFilter&& allow) -> vector<uint32_t> {
+        searchStats = PathSearchStats();
+        if (s == t) {
+            searchStats.length = 0;
+            return {s};
+        }
+        // 查询编号回绕时清空时间戳，避免与很久以前的查询混淆
+        if (++query == 0) {
+            fill(forward.stamp.begin(), forward.stamp.end(), 0);
+            fill(backward.stamp.begin(), backward.stamp.end(), 0);
+            query = 1;
+        }
+        forward.prepare(g.vertexCount(), g.maxWeight);
+        backward.prepare(g.vertexCount(), g.maxWeight);
+        forward.reach(s, 0, WordInterner::npos, query);
+        backward.reach(t, 0, WordInterner::npos, query);
+
+        int64_t best = INT64_MAX;
+        uint32_t meet = WordInterner::npos;
+        while (!forward.queue.empty() && !backward.queue.empty()) {
+            const int forwardTop = forward.queue.top();
+            const int backwardTop = backward.queue.top();
+            if (static_cast<int64_t>(forwardTop) + backwardTop >= best) { break;
+}
+            const bool isForward = forwardTop <= backwardTop;
+            SearchFrontier<Queue>& side = isForward ? forward : backward;
+            const SearchFrontier<Queue>& other = isForward ? backward : forward;
+            const auto& offsets = isForward ? g.offsets : g.inOffsets;
+            const auto& neighbors = isForward ? g.targets : g.inSources;
+            const auto& weights = isForward ? g.weights : g.inWeights;
+
+            auto [d, u] = side.queue.pop();
+            if (d > side.dist[u]) { continue;
+}
+            searchStats.settled++;
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = neighbors[e];
+                if (!(isForward ? allow(u, v) : allow(v, u))) { continue;
+}
+                int nd = d + weights[e];
+                searchStats.relaxed++;
+                if (nd < side.distance(v, query)) {
+                    side.reach(v, nd, u, query);
+                }
+                int rest = other.distance(v, query);
+                if (rest != INT_MAX && static_cast<int64_t>(nd) + rest < best) {
+                    best = static_cast<int64_t>(nd) + rest;
+                    meet = v;
+                }
+            }
+        }
+
+        vector<uint32_t> path;
+        if (meet == WordInterner::npos) { return path;
+}
+        searchStats.length = best;
+        for (uint32_t cur = meet; cur != WordInterner::npos; cur = forward.parent[cur]) {
+            path.push_back(cur);
+        }
+        reverse(path.begin(), path.end());
+        for (uint32_t cur = backward.parent[meet]; cur != WordInterner::npos; cur = backward.parent[cur]) {
+            path.push_back(cur);
+        }
+        return path;
+    }
+
+    auto stats() const -> const PathSearchStats& { return searchStats; }
+
+private:
+    SearchFrontier<Queue> forward;
+    SearchFrontier<Queue> backward;
+    uint32_t query = 0;
+    PathSearchStats searchStats;
+};
+
+// CSR 的指纹：节点数、边数与全部边（含权重）的 64 位混合哈希，用来判断磁盘上的预处理结果是否对应当前的图
+inline auto csrFingerprint(const CsrGraph& g) -> uint64_t {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 0x100000001b3ULL; hash ^= hash >> 29; };
+    mix(g.vertexCount());
+    mix(g.edgeCount());
+    for (uint64_t offset : g.offsets) { mix(offset);
+}
+    for (size_t e = 0; e < g.edgeCount(); ++e) {
+        mix((static_cast<uint64_t>(g.targets[e]) << 32) | static_cast<uint32_t>(g.weights[e]));
+    }
+    return hash;
+}
+
+// ALT 的地标表：对每个地标 L 记下 d(L, v) 与 d(v, L)，按节点连续存放（[v * K + k]），
+// 查询时由三角不等式给出到目标的距离下界
+class LandmarkIndex {
+public:
+    // 第一个地标取度数最大的节点，之后每次取与已选地标"往返距离"最小值最大的节点（farthest 选法）
+    void build(const CsrGraph& g, unsigned count) {
+        clear();
+        const size_t V = g.vertexCount();
+        requested = count;
+        if (V == 0 || count == 0) { return;
+}
+        vertices = V;
+        vector<vector<int>> from;
+        vector<vector<int>> to;
+        vector<int> spread(V, INT_MAX);
+        uint32_t next = 0;
+        for (uint32_t v = 1; v < V; ++v) {
+            if (g.outDegree(v) + g.inDegree(v) > g.outDegree(next) + g.inDegree(next)) { next = v;
+}
+        }
+        ShortestPathTree tree;
+        while (landmarks.size() < count) {
+            landmarks.push_back(next);
+            runDijkstra(g, next, tree);
+            from.push_back(tree.dist);
+            runDijkstra(g, next, tree, true);
+            to.push_back(tree.dist);
+
+            int farthest = 0;
+            for (uint32_t v = 0; v < V; ++v) {
+                if (from.back()[v] != INT_MAX && to.back()[v] != INT_MAX) {
+                    spread[v] = min(spread[v], from.back()[v] + to.back()[v]);
+                }
+                if (spread[v] != INT_MAX && spread[v] > farthest) {
+                    farthest = spread[v];
+                    next = v;
+                }
+            }
+            // 剩下的节点都已经是地标或与地标不连通，再加地标没有意义
+            if (farthest == 0) { break;
+}
+        }
+
+        const size_t K = landmarks.size();
+        fromLandmark.resize(V * K);
+        toLandmark.resize(V * K);
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t v = 0; v < V; ++v) {
+                fromLandmark[v * K + k] = from[k][v];
+                toLandmark[v * K + k] = to[k][v];
+            }
+        }
+    }
+
+    void clear() {
+        landmarks.clear();
+        fromLandmark.clear();
+        toLandmark.clear();
+        vertices = 0;
+        requested = 0;
+    }
+
+    auto empty() const -> bool { return landmarks.empty(); }
+    auto size() const -> size_t { return landmarks.size(); }
+    // build 时要求的地标数；图太小或不连通时实际选出的 size() 可能更少
+    auto requestedSize() const -> unsigned { return requested; }
+
+    // d(v, t) 的下界：d(L, t) - d(L, v) 与 d(v, L) - d(t, L) 中的最大值。
+    // t 能到达某个地标而 v 不能时，v 一定到不了 t，返回 INT_MAX
+    auto lowerBound(uint32_t v, uint32_t t) const -> int {
+        const size_t K = landmarks.size();
+        const int* fromV = fromLandmark.data() + v * K;
+        const int* fromT = fromLandmark.data() + t * K;
+        const int* toV = toLandmark.data() + v * K;
+        const int* toT = toLandmark.data() + t * K;
+        int bound = 0;
+        for (size_t k = 0; k < K; ++k) {
+            if (fromT[k] != INT_MAX && fromV[k] != INT_MAX) {
+                bound = max(bound, fromT[k] - fromV[k]);
+            }
+            if (toT[k] != INT_MAX) {
+                if (toV[k] == INT_MAX) { return INT_MAX;
+}
+                bound = max(bound, toV[k] - toT[k]);
+            }
+        }
+        return bound;
+    }
+
+    // 文件格式：魔数、版本、地标数、要求的地标数、节点数、图指纹，之后是地标编号与两张距离表
+    auto save(const string& path, uint64_t fingerprint) const -> bool {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) { return false;
+}
+        const uint32_t K = landmarks.size();
+        const uint64_t V = vertices;
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        out.write(reinterpret_cast<const char*>(&K), sizeof(K));
+        out.write(reinterpret_cast<const char*>(&requested), sizeof(requested));
+        out.write(reinterpret_cast<const char*>(&V), sizeof(V));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        out.write(reinterpret_cast<const char*>(landmarks.data()), static_cast<streamsize>(K * sizeof(uint32_t)));
+        out.write(reinterpret_cast<const char*>(fromLandmark.data()), static_cast<streamsize>(fromLandmark.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(toLandmark.data()), static_cast<streamsize>(toLandmark.size() * sizeof(int)));
+        return static_cast<bool>(out);
+    }
+
+    // 文件不存在、格式不符、长度与头部不一致或指纹与当前的图不一致时返回 false，原有的表保持不变
+    auto load(const string& path, uint64_t fingerprint, size_t vertexCount) -> bool {
+        ifstream in(path, ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        uint32_t version = 0;
+        uint32_t K = 0;
+        uint32_t requestedK = 0;
+        uint64_t V = 0;
+        uint64_t stored = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&K), sizeof(K));
+        in.read(reinterpret_cast<char*>(&requestedK), sizeof(requestedK));
+        in.read(reinterpret_cast<char*>(&V), sizeof(V));
+        in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        if (!in || memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kVersion || V != vertexCount ||
+            stored != fingerprint || K > V || K > requestedK) {
+            return false;
+        }
+        // 先核对剩余长度，再按头部给出的大小分配，损坏或截断的文件不会触发巨大的分配
+        const auto header = in.tellg();
+        in.seekg(0, ios::end);
+        const auto remaining = static_cast<uint64_t>(in.tellg() - header);
+        in.seekg(header);
+        if (remaining != K * sizeof(uint32_t) + 2 * V * K * sizeof(int)) { return false;
+}
+        LandmarkIndex loaded;
+        loaded.vertices = V;
+        loaded.requested = requestedK;
+        loaded.landmarks.resize(K);
+        loaded.fromLandmark.resize(V * K);
+        loaded.toLandmark.resize(V * K);
+        in.read(reinterpret_cast<char*>(loaded.landmarks.data()), static_cast<streamsize>(K * sizeof(uint32_t)));
+        in.read(reinterpret_cast<char*>(loaded.fromLandmark.data()), static_cast<streamsize>(V * K * sizeof(int)));
+        in.read(reinterpret_cast<char*>(loaded.toLandmark.data()), static_cast<streamsize>(V * K * sizeof(int)));
+        if (!in) { return false;
+}
+        *this = move(loaded);
+        return true;
+    }
+
+private:
+    static constexpr char kMagic[8] = {'W', 'G', 'A', 'L', 'T', 'I', 'D', 'X'};
+    static constexpr uint32_t kVersion = 2;
+
+    vector<uint32_t> landmarks;
+    size_t vertices = 0;
+    uint32_t requested = 0;
+    vector<int> fromLandmark;   // [v * K + k] = d(landmarks[k], v)
+    vector<int> toLandmark;     // [v * K + k] = d(v, landmarks[k])
+};
+
+// 以地标下界为势函数的双向 A*（ALT）。正反两侧使用平均势函数
+// p(v) = (πf(v) - πr(v)) / 2，其中 πf(v) 是 d(v, t) 的下界、πr(v) 是 d(s, v) 的下界，
+// 两侧的约化边权都非负，停止条件与双向 Dijkstra 相同。为保持整数，键统一乘以 2：
+// 正向键 2·df(v) + (πf - πr)，反向键 2·dr(v) - (πf - πr)，二者都非负且单调不减。
+// 但一条边让键增加的量最多可达 4 × 最大边权，超出 Dial 桶队列 maxWeight + 1 个桶的窗口，
+// 所以只能用不限制键跨度的基数堆或二叉堆。
+// 某一侧的下界为 INT_MAX 说明 v 不可能在 s -> t 的路径上，直接剪掉
+template <class Queue = PathQueue>
+class LandmarkAStar {
+    static_assert(is_same_v<Queue, RadixHeapQueue> || is_same_v<Queue, BinaryHeapQueue>,
+                  "ALT keys can jump by up to 4 * maxWeight, which DialQueue cannot hold");
+
+public:
+    auto search(const CsrGraph& g, const LandmarkIndex& index, uint32_t s, uint32_t t) -> vector<uint32_t> {
+        searchStats = PathSearchStats();
+        vector<uint32_t> path;
+        if (s == t) {
+            searchStats.length = 0;
+            return {s};
+        }
+        if (++query == 0) {
+            fill(forward.stamp.begin(), forward.stamp.end(), 0);
+            fill(backward.stamp.begin(), backward.stamp.end(), 0);
+            fill(potentialStamp.begin(), potentialStamp.end(), 0);
+            query = 1;
+        }
+        forward.prepare(g.vertexCount(), g.maxWeight);
+        backward.prepare(g.vertexCount(), g.maxWeight);
+        if (potentialStamp.size() < g.vertexCount()) {
+            potential.resize(g.vertexCount());
+            potentialStamp.resize(g.vertexCount(), 0);
+        }
+        source = s;
+        target = t;
+        const int sourcePotential = potentialOf(index, s);
+        const int targetPotential = potentialOf(index, t);
+        if (sourcePotential == INT_MAX || targetPotential == INT_MAX) { return path;
+}
+        forward.reach(s, 0, WordInterner::npos, query, sourcePotential);
+        backward.reach(t, 0, WordInterner::npos, query, -targetPotential);
+
+        int64_t best = INT64_MAX;
+        uint32_t meet = WordInterner::npos;
+        while (!forward.queue.empty() && !backward.queue.empty()) {
+            const int forwardTop = forward.queue.top();
+            const int backwardTop = backward.queue.top();
+            if (best != INT64_MAX && static_cast<int64_t>(forwardTop) + backwardTop >= 2 * best) { break;
+}
+            const bool isForward = forwardTop <= backwardTop;
+            const int sign = isForward ? 1 : -1;
+            SearchFrontier<Queue>& side = isForward ? forward : backward;
+            const SearchFrontier<Queue>& other = isForward ? backward : forward;
+            const auto& offsets = isForward ? g.offsets : g.inOffsets;
+            const auto& neighbors = isForward ? g.targets : g.inSources;
+            const auto& weights = isForward ? g.weights : g.inWeights;
+
+            auto [key, u] = side.queue.pop();
+            const int d = side.dist[u];
+            if (key > 2 * d + sign * potential[u]) { continue;
+}
+            searchStats.settled++;
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = neighbors[e];
+                int nd = d + weights[e];
+                searchStats.relaxed++;
+                int p = potentialOf(index, v);
+                if (p == INT_MAX) { continue;
+}
+                if (nd < side.distance(v, query)) {
+                    side.reach(v, nd, u, query, 2 * nd + sign * p);
+                }
+                int rest = other.distance(v, query);
+                if (rest != INT_MAX && static_cast<int64_t>(nd) + rest < best) {
+                    best = static_cast<int64_t>(nd) + rest;
+                    meet = v;
+                }
+            }
+        }
+
+        if (meet == WordInterner::npos) { return path;
+}
+        searchStats.length = best;
+        for (uint32_t cur = meet; cur != WordInterner::npos; cur = forward.parent[cur]) {
+            path.push_back(cur);
+        }
+        reverse(path.begin(), path.end());
+        for (uint32_t cur = backward.parent[meet]; cur != WordInterner::npos; cur = backward.parent[cur]) {
+            path.push_back(cur);
+        }
+        return path;
+    }
+
+    auto stats() const -> const PathSearchStats& { return searchStats; }
+
+private:
+    // πf(v) - πr(v)，每次查询对每个节点只算一次；v 不可能在路径上时为 INT_MAX
+    auto potentialOf(const LandmarkIndex& index, uint32_t v) -> int {
+        if (potentialStamp[v] != query) {
+            potentialStamp[v] = query;
+            int toTarget = index.lowerBound(v, target);
+            int fromSource = index.lowerBound(source, v);
+            potential[v] = (toTarget == INT_MAX || fromSource == INT_MAX) ? INT_MAX : toTarget - fromSource;
+        }
+        return potential[v];
+    }
+
+    SearchFrontier<Queue> forward;
+    SearchFrontier<Queue> backward;
+    vector<int> potential;
+    vector<uint32_t> potentialStamp;
+    uint32_t query = 0;
+    uint32_t source = 0;
+    uint32_t target = 0;
+    PathSearchStats searchStats;
+};
+
+// k 短路中的一条：节点序列与总权重
+struct RankedPath {
+    vector<uint32_t> vertices;
+    int64_t length = 0;
+};
+
+// Yen 算法求前 k 条无环最短路径。候选路径放在一棵前缀树里，每个树节点只记顶点、父节点和
+// 从起点到此的长度，候选之间以及候选与已选路径共享相同的前缀，不必各自复制整条路径。
+// 按 Lawler 的改进，每条新选出的路径只从它的偏离点开始求支路，偏离点之前的支路在处理它的
+// 前一条路径时已经求过。支路用带删边过滤的双向 Dijkstra 搜索，工作区在各次搜索间复用
+template <class Queue = PathQueue>
+class YenKShortestPaths {
+public:
+    auto search(const CsrGraph& g, uint32_t s, uint32_t t, size_t k) -> vector<RankedPath> {
+        vector<RankedPath> accepted;
+        nodes.clear();
+        seen.clear();
+        candidates.clear();
+        if (k == 0) { return accepted;
+}
+        auto first = spurSearch.search(g, s, t);
+        if (first.empty()) { return accepted;
+}
+        uint32_t tail = extend(g, WordInterner::npos, first);
+        addCandidate(tail, 0);
+        if (blockStamp.size() < g.vertexCount()) { blockStamp.resize(g.vertexCount(), 0);
+}
+
+        vector<uint32_t> chain;
+        vector<uint32_t> blockedNext;
+        while (accepted.size() < k && !candidates.empty()) {
+            pop_heap(candidates.begin(), candidates.end(), greater<>());
+            Candidate best = candidates.back();
+            candidates.pop_back();
+
+            chain.clear();
+            for (uint32_t node = best.tail; node != WordInterner::npos; node = nodes[node].parent) {
+                chain.push_back(node);
+            }
+            reverse(chain.begin(), chain.end());
+            RankedPath path;
+            path.length = best.length;
+            for (uint32_t node : chain) {
+                path.vertices.push_back(nodes[node].vertex);
+            }
+            accepted.push_back(move(path));
+            if (accepted.size() == k) { break;
+}
+
+            const auto& p = accepted.back().vertices;
+            for (size_t i = best.deviation; i + 1 < p.size(); ++i) {
+                const uint32_t spurVertex = p[i];
+                // 根路径上除支点以外的节点都不能再经过，保证无环
+                if (++blockQuery == 0) {
+                    fill(blockStamp.begin(), blockStamp.end(), 0);
+                    blockQuery = 1;
+                }
+                for (size_t j = 0; j < i; ++j) {
+                    blockStamp[p[j]] = blockQuery;
+                }
+                // 与当前路径根部相同的已选路径，在支点处走过的边都要删掉
+                blockedNext.clear();
+                for (const auto& other : accepted) {
+                    if (other.vertices.size() > i + 1 && equal(p.begin(), p.begin() + static_cast<ptrdiff_t>(i) + 1, other.vertices.begin())) {
+                        blockedNext.push_back(other.vertices[i + 1]);
+                    }
+                }
+                auto spur = spurSearch.search(g, spurVertex, t, [&](uint32_t u, uint32_t v) {
+                    if (blockStamp[u] == blockQuery || blockStamp[v] == blockQuery) { return false;
+}
+                    return u != spurVertex || find(blockedNext.begin(), blockedNext.end(), v) == blockedNext.end();
+                });
+                if (spur.empty()) { continue;
+}
+                size_t before = nodes.size();
+                uint32_t candidate = extend(g, chain[i], spur);
+                if (!addCandidate(candidate, i)) {
+                    nodes.resize(before);
+                }
+            }
+        }
+        return accepted;
+    }
+
+private:
+    struct PrefixNode {
+        uint32_t vertex;
+        uint32_t parent;
+        int64_t length;
+        uint64_t hash;     // 从起点到此的顶点序列的哈希，用于候选去重
+    };
+
+    struct Candidate {
+        int64_t length;
+        uint32_t tail;
+        size_t deviation;  // 偏离点（支点）在路径中的位置
+
+        auto operator>(const Candidate& other) const -> bool {
+            return length != other.length ? length > other.length : tail > other.tail;
+        }
+    };
+
+    // 把 vertices[1..]（parent 为 npos 时从 vertices[0] 开始）接到前缀树节点 parent 之后，返回新的末端节点
+    auto extend(const CsrGraph& g, uint32_t parent, const vector<uint32_t>& vertices) -> uint32_t {
+        for (size_t i = parent == WordInterner::npos ? 0 : 1; i < vertices.size(); ++i) {
+            PrefixNode node{vertices[i], parent, 0, 0xcbf29ce484222325ULL};
+            if (parent != WordInterner::npos) {
+                const PrefixNode& prev = nodes[parent];
+                node.length = prev.length + g.weights[g.findEdge(prev.vertex, node.vertex)];
+                node.hash = prev.hash;
+            }
+            node.hash = (node.hash ^ node.vertex) * 0x100000001b3ULL;
+            nodes.push_back(node);
+            parent = static_cast<uint32_t>(nodes.size() - 1);
+        }
+        return parent;
+    }
+
+    // 与已有候选（包括已选出的路径）重复时返回 false
+    auto addCandidate(uint32_t tail, size_t deviation) -> bool {
+        auto& sameHash = seen[nodes[tail].hash];
+        for (uint32_t other : sameHash) {
+            if (samePath(tail, other)) { return false;
+}
+        }
+        sameHash.push_back(tail);
+        candidates.push_back({nodes[tail].length, tail, deviation});
+        push_heap(candidates.begin(), candidates.end(), greater<>());
+        return true;
+    }
+
+    auto samePath(uint32_t a, uint32_t b) const -> bool {
+        while (a != WordInterner::npos && b != WordInterner::npos) {
+            if (a == b) { return true;
+}
+            if (nodes[a].vertex != nodes[b].vertex) { return false;
+}
+            a = nodes[a].parent;
+            b = nodes[b].parent;
+        }
+        return a == b;
+    }
+
+    BidirectionalDijkstra<Queue> spurSearch;
+    vector<PrefixNode> nodes;
+    unordered_map<uint64_t, vector<uint32_t>> seen;
+    vector<Candidate> candidates;     // 以 greater<> 维护的小根堆
+    vector<uint32_t> blockStamp;
+    uint32_t blockQuery = 0;
+};
+
+// 开放寻址的 64 位键集合，用来记录一次游走走过的边（键为 edgeKey）。槽位的代数（stamp）
+// 与当前代数不同即视为空，clear() 只需递增代数，反复清空不必重新填充数组，容量也会保留下来
+class EdgeSet {
+public:
+    void clear() {
+        if (++generation == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+        count = 0;
+    }
+
+    // 插入 key，已经存在时返回 false
+    auto insert(uint64_t key) -> bool {
+        if ((count + 1) * 2 > keys.size()) { grow();
+}
+        const size_t mask = keys.size() - 1;
+        for (size_t i = hashOf(key) & mask;; i = (i + 1) & mask) {
+            if (stamps[i] != generation) {
+                stamps[i] = generation;
+                keys[i] = key;
+                count++;
+                return true;
+            }
+            if (keys[i] == key) { return false;
+}
+        }
+    }
+
+    auto size() const -> size_t { return count; }
+
+private:
+    static auto hashOf(uint64_t key) -> size_t {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    // 容量翻倍（至少 64 个槽位），把当前代数的键重新放入
+    void grow() {
+        vector<uint64_t> oldKeys = move(keys);
+        vector<uint32_t> oldStamps = move(stamps);
+        keys.assign(max<size_t>(64, oldKeys.size() * 2), 0);
+        stamps.assign(keys.size(), 0);
+        const size_t mask = keys.size() - 1;
+        for (size_t j = 0; j < oldKeys.size(); ++j) {
+            if (oldStamps[j] != generation) { continue;
+}
+            size_t i = hashOf(oldKeys[j]) & mask;
+            while (stamps[i] == generation) { i = (i + 1) & mask;
+}
+            stamps[i] = generation;
+            keys[i] = oldKeys[j];
+        }
+    }
+
+    vector<uint64_t> keys;
+    vector<uint32_t> stamps;
+    uint32_t generation = 1;
+    size_t count = 0;
+};
+
+// 一次游走的工作区：走过的边与节点序列。同一个 scratch 反复使用时，游走本身不再分配内存
+struct WalkScratch {
+    EdgeSet visited;
+    vector<uint32_t> path;
+};
+
+// 按边权采样出边的别名表（Vose 方法），与 CSR 的边一一对应：抽到 u 的第 i 条出边（下标 e）后，
+// 以 threshold[e] / 2^32 的概率保留 i，否则改取 alias[e]，每一步都是 O(1)
+struct AliasTables {
+    vector<uint32_t> threshold;
+    vector<uint32_t> alias;
+    vector<double> totals;      // 每个节点出边的边权之和
+
+    void build(const CsrGraph& g) {
+        threshold.assign(g.edgeCount(), UINT32_MAX);
+        alias.assign(g.edgeCount(), 0);
+        totals.assign(g.vertexCount(), 0.0);
+        vector<double> scaled;
+        vector<uint32_t> small;
+        vector<uint32_t> large;
+        for (uint32_t u = 0; u < g.vertexCount(); ++u) {
+            const uint64_t base = g.offsets[u];
+            const size_t degree = g.outDegree(u);
+            if (degree == 0) { continue;
+}
+            double total = 0.0;
+            for (size_t i = 0; i < degree; ++i) { total += g.weights[base + i];
+}
+            totals[u] = total;
+            scaled.resize(degree);
+            small.clear();
+            large.clear();
+            for (size_t i = 0; i < degree; ++i) {
+                scaled[i] = g.weights[base + i] * static_cast<double>(degree) / total;
+                (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+            }
+            while (!small.empty() && !large.empty()) {
+                uint32_t less = small.back();
+                small.pop_back();
+                uint32_t more = large.back();
+                threshold[base + less] = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+                alias[base + less] = more;
+                scaled[more] -= 1.0 - scaled[less];
+                if (scaled[more] < 1.0) {
+                    large.pop_back();
+                    small.push_back(more);
+                }
+            }
+            // 剩下的（包括浮点误差留下的）都以概率 1 保留自己
+            for (uint32_t i : small) { alias[base + i] = i;
+}
+            for (uint32_t i : large) { alias[base + i] = i;
+}
+        }
+    }
+
+    // base 为节点的第一条出边下标，i 为均匀抽到的出边序号，random32 为 32 位随机数
+    auto sample(uint64_t base, uint64_t i, uint32_t random32) const -> uint64_t {
+        return random32 < threshold[base + i] ? i : alias[base + i];
+    }
+};
+
+// 游走结果的去向：randomWalk 每得到一条游走就调用一次 write
+class WalkSink {
+public:
+    virtual ~WalkSink() = default;
+    virtual void write(string_view walk) = 0;
+    // 等到之前写入的游走都已交给底层，返回这些写入是否全部成功
+    virtual auto flush() -> bool { return true; }
+};
+
+// 丢弃结果
+class NullWalkSink : public WalkSink {
+public:
+    void write(string_view /*walk*/) override {}
+};
+
+// 把结果保存在内存里，按写入顺序排列
+class MemoryWalkSink : public WalkSink {
+public:
+    void write(string_view walk) override { walks.emplace_back(walk); }
+    auto results() const -> const vector<string>& { return walks; }
+    void clear() { walks.clear(); }
+
+private:
+    vector<string> walks;
+};
+
+// 每次写入都截断重写文件，文件里只有最近一条游走。这是 randomWalk 原来写 random_walk.txt 的行为，也是默认的去向
+class TruncatingFileWalkSink : public WalkSink {
+public:
+    explicit TruncatingFileWalkSink(string path = "random_walk.txt") : path(move(path)) {}
+
+    void write(string_view walk) override {
+        ofstream out(path);
+        out << walk;
+        ok = ok && static_cast<bool>(out);
+    }
+
+    auto flush() -> bool override { return ok; }
+
+private:
+    string path;
+    bool ok = true;
+};
+
+// 文件只打开一次（打开时截断），每条游走写成一行，由流自己的缓冲区攒批写出
+class BufferedFileWalkSink : public WalkSink {
+public:
+    explicit BufferedFileWalkSink(const string& path) : out(path) {}
+
+    void write(string_view walk) override {
+        out << walk << '\n';
+    }
+
+    auto flush() -> bool override {
+        out.flush();
+        return static_cast<bool>(out);
+    }
+
+private:
+    ofstream out;
+};
+
+// 把写入转交给后台线程，由它调用 target 完成真正的 I/O。队列最多暂存 capacity 条游走，
+// 满了以后 write 阻塞等待，内存占用有上限。析构时先写完队列里剩下的游走
+class AsyncWalkSink : public WalkSink {
+public:
+    explicit AsyncWalkSink(unique_ptr<WalkSink> target, size_t capacity = 1024)
+        : target(move(target)), capacity(max<size_t>(capacity, 1)), writer([this] { run(); }) {}
+
+    ~AsyncWalkSink() override {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        changed.notify_all();
+        writer.join();
+    }
+
+    AsyncWalkSink(const AsyncWalkSink&) = delete;
+    auto operator=(const AsyncWalkSink&) -> AsyncWalkSink& = delete;
+
+    void write(string_view walk) override {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return queue.size() < capacity; });
+        queue.emplace_back(walk);
+        changed.notify_all();
+    }
+
+    auto flush() -> bool override {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return queue.empty() && !busy; });
+        return target->flush();
+    }
+
+private:
+    void run() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            changed.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) { break;
+}
+            string walk = move(queue.front());
+            queue.pop_front();
+            busy = true;
+            changed.notify_all();
+            lock.unlock();
+            target->write(walk);
+            lock.lock();
+            busy = false;
+            changed.notify_all();
+        }
+    }
+
+    unique_ptr<WalkSink> target;
+    const size_t capacity;
+    mutex mtx;
+    condition_variable changed;
+    deque<string> queue;
+    bool busy = false;
+    bool stopping = false;
+    thread writer;  // 最后初始化：线程启动时其余成员都已就绪
+};
+
+// 桥接词查询的结果状态
+enum class BridgeStatus { Found, NoBridge, MissingWord1, MissingWord2, MissingBoth };
+
+// 桥接词查询结果：status 为 Found 时 [ids, ids + count) 是按编号升序的桥接词。
+// ids 指向图内部的缓存，在下一次桥接词查询或 addEdge 之前有效
+struct BridgeResult {
+    BridgeStatus status = BridgeStatus::NoBridge;
+    const uint32_t* ids = nullptr;
+    size_t count = 0;
+
+    auto found() const -> bool { return status == BridgeStatus::Found; }
+    auto size() const -> size_t { return count; }
+    auto operator[](size_t i) const -> uint32_t { return ids[i]; }
+    auto begin() const -> const uint32_t* { return ids; }
+    auto end() const -> const uint32_t* { return ids + count; }
+};
+
+// 桥接词查询结果的命中统计
+struct BridgeCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// 桥接词结果的 LRU 缓存，以 (word1, word2) 编号对为键，按估算的内存占用设上限。
+// 结果只取决于 word1 的出边和 word2 的入边，所以每个节点记一个出边/入边版本号，
+// addEdge 时递增两端的版本号；条目记录写入时的版本号，查到版本不一致即视为失效
+class BridgeCache {
+public:
+    explicit BridgeCache(size_t capacityBytes = 8u << 20) : capacity(capacityBytes) {}
+
+    // 命中时返回缓存的结果，未命中或已失效时返回 nullptr
+    auto find(uint32_t word1, uint32_t word2) -> const vector<uint32_t>* {
+        auto it = index.find(edgeKey(word1, word2));
+        if (it == index.end()) {
+            counters.misses++;
+            return nullptr;
+        }
+        auto entry = it->second;
+        if (entry->outVersion != versionOf(outVersions, word1) || entry->inVersion != versionOf(inVersions, word2)) {
+            erase(entry);
+            counters.misses++;
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, entry);
+        counters.hits++;
+        return &entry->ids;
+    }
+
+    auto insert(uint32_t word1, uint32_t word2, vector<uint32_t> ids) -> const vector<uint32_t>& {
+        uint64_t key = edgeKey(word1, word2);
+        auto it = index.find(key);
+        if (it != index.end()) { erase(it->second);
+}
+        lru.push_front({key, versionOf(outVersions, word1), versionOf(inVersions, word2), move(ids)});
+        index.emplace(key, lru.begin());
+        used += footprint(lru.front());
+        // 至少保留刚插入的条目，即使它本身就超过了上限
+        while (used > capacity && lru.size() > 1) {
+            erase(prev(lru.end()));
+            counters.evictions++;
+        }
+        return lru.front().ids;
+    }
+
+    // src -> dest 新增或加重了一条边：src 的出边、dest 的入边发生变化。
+    // 缓存为空时没有需要失效的条目，直接跳过，建图阶段的大量 addEdge 不必付出代价
+    void touch(uint32_t src, uint32_t dest) {
+        if (lru.empty()) { return;
+}
+        bump(outVersions, src);
+        bump(inVersions, dest);
+    }
+
+    void setCapacity(size_t bytes) {
+        capacity = bytes;
+        while (used > capacity && !lru.empty()) {
+            erase(prev(lru.end()));
+            counters.evictions++;
+        }
+    }
+
+    void clear() {
+        lru.clear();
+        index.clear();
+        used = 0;
+    }
+
+    auto stats() const -> BridgeCacheStats {
+        BridgeCacheStats result = counters;
+        result.entries = lru.size();
+        result.bytes = used;
+        return result;
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t outVersion;
+        uint32_t inVersion;
+        vector<uint32_t> ids;
+    };
+    using EntryIter = list<Entry>::iterator;
+
+    // 链表节点、哈希表节点与结果数组的大致开销
+    static auto footprint(const Entry& entry) -> size_t {
+        return sizeof(Entry) + 2 * sizeof(void*) + sizeof(pair<uint64_t, EntryIter>) + 2 * sizeof(void*) +
+               entry.ids.capacity() * sizeof(uint32_t);
+    }
+
+    static auto versionOf(const vector<uint32_t>& versions, uint32_t v) -> uint32_t {
+        return v < versions.size() ? versions[v] : 0;
+    }
+
+    static void bump(vector<uint32_t>& versions, uint32_t v) {
+        if (v >= versions.size()) { versions.resize(v + 1, 0);
+}
+        versions[v]++;
+    }
+
+    void erase(EntryIter entry) {
+        used -= footprint(*entry);
+        index.erase(entry->key);
+        lru.erase(entry);
+    }
+
+    size_t capacity;
+    size_t used = 0;
+    list<Entry> lru;                               // 表头为最近使用的条目
+    unordered_map<uint64_t, EntryIter> index;
+    vector<uint32_t> outVersions;
+    vector<uint32_t> inVersions;
+    BridgeCacheStats counters;
+};
+
+// 图快照文件的布局：96 字节头部之后依次是词表偏移、词表、单词查找表、CSR 的六个数组、可选的 PageRank
+// 和可选的 TF-IDF 权重（llm_1 的 PageRank 以它作随机跳转分布），
+// 每段从 8 字节对齐处开始，映射后可以直接当数组使用。各段的位置只由头部里的计数决定，写入和加载共用这份计算。
+// 数值按本机字节序保存，快照只在同一种机器之间共享
+struct SnapshotLayout {
+    static constexpr char kMagic[8] = {'W', 'G', 'S', 'N', 'A', 'P', 'S', 'H'};
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kHasPageRank = 1;
+    // PageRank 段是按 TF-IDF 随机跳转算出的（llm_1），没有这一位表示均匀随机跳转（llm）。
+    // 两个程序只使用与自己算法一致的 PageRank 段，另一种直接忽略、之后重新计算
+    static constexpr uint32_t kTfidfTeleport = 2;
+    static constexpr uint32_t kHasTfidf = 4;
+    static constexpr size_t kHeaderBytes = 96;
+
+    // 头部字段（按顺序）：魔数、版本、标志、节点数、边数、词表字节数、查找表槽位数、最大边权、文件总长，
+    // 以及计算 PageRank 段时的阻尼系数、收敛容差与迭代轮数（增量刷新要用同样的参数接着算）
+    uint32_t flags = 0;
+    uint64_t vertices = 0;
+    uint64_t edges = 0;
+    uint64_t vocabBytes = 0;
+    uint64_t indexSlots = 0;
+    int32_t maxWeight = 0;
+    uint64_t fileBytes = 0;
+    double damping = 0.0;
+    double tolerance = 0.0;
+    int32_t iterations = 0;
+
+    // 各段在文件中的起始位置，由 place() 计算
+    uint64_t wordOffsets = 0;
+    uint64_t vocab = 0;
+    uint64_t index = 0;
+    uint64_t offsets = 0;
+    uint64_t targets = 0;
+    uint64_t weights = 0;
+    uint64_t inOffsets = 0;
+    uint64_t inSources = 0;
+    uint64_t inWeights = 0;
+    uint64_t pageRank = 0;
+    uint64_t tfidf = 0;
+
+    static auto matches(const char* data, size_t size) -> bool {
+        return size >= sizeof(kMagic) && memcmp(data, kMagic, sizeof(kMagic)) == 0;
+    }
+
+    static auto padding(uint64_t bytes) -> uint64_t {
+        return (8 - bytes % 8) % 8;
+    }
+
+    auto hasPageRank() const -> bool {
+        return (flags & kHasPageRank) != 0u;
+    }
+
+    auto tfidfTeleport() const -> bool {
+        return (flags & kTfidfTeleport) != 0u;
+    }
+
+    auto hasTfidf() const -> bool {
+        return (flags & kHasTfidf) != 0u;
+    }
+
+    void place() {
+        uint64_t pos = kHeaderBytes;
+        auto section = [&pos](uint64_t bytes) {
+            uint64_t start = pos;
+            pos += bytes + padding(bytes);
+            return start;
+        };
+        wordOffsets = section((vertices + 1) * sizeof(uint64_t));
+        vocab = section(vocabBytes);
+        index = section(indexSlots * sizeof(uint32_t));
+        offsets = section((vertices + 1) * sizeof(uint64_t));
+        targets = section(edges * sizeof(uint32_t));
+        weights = section(edges * sizeof(int));
+        inOffsets = section((vertices + 1) * sizeof(uint64_t));
+        inSources = section(edges * sizeof(uint32_t));
+        inWeights = section(edges * sizeof(int));
+        pageRank = section(hasPageRank() ? vertices * sizeof(double) : 0);
+        tfidf = section(hasTfidf() ? vertices * sizeof(double) : 0);
+        fileBytes = pos;
+    }
+
+    auto header() const -> string {
+        string bytes(kHeaderBytes, '\0');
+        memcpy(&bytes[0], kMagic, sizeof(kMagic));
+        memcpy(&bytes[8], &kVersion, sizeof(kVersion));
+        memcpy(&bytes[12], &flags, sizeof(flags));
+        memcpy(&bytes[16], &vertices, sizeof(vertices));
+        memcpy(&bytes[24], &edges, sizeof(edges));
+        memcpy(&bytes[32], &vocabBytes, sizeof(vocabBytes));
+        memcpy(&bytes[40], &indexSlots, sizeof(indexSlots));
+        memcpy(&bytes[48], &maxWeight, sizeof(maxWeight));
+        memcpy(&bytes[56], &fileBytes, sizeof(fileBytes));
+        memcpy(&bytes[64], &damping, sizeof(damping));
+        memcpy(&bytes[72], &tolerance, sizeof(tolerance));
+        memcpy(&bytes[80], &iterations, sizeof(iterations));
+        return bytes;
+    }
+
+    // 解析头部并计算各段位置。魔数或版本不符、计数与文件长度对不上时返回 false
+    auto parse(const char* data, size_t size) -> bool {
+        if (size < kHeaderBytes || !matches(data, size)) { return false;
+}
+        uint32_t version = 0;
+        uint64_t storedBytes = 0;
+        memcpy(&version, data + 8, sizeof(version));
+        memcpy(&flags, data + 12, sizeof(flags));
+        memcpy(&vertices, data + 16, sizeof(vertices));
+        memcpy(&edges, data + 24, sizeof(edges));
+        memcpy(&vocabBytes, data + 32, sizeof(vocabBytes));
+        memcpy(&indexSlots, data + 40, sizeof(indexSlots));
+        memcpy(&maxWeight, data + 48, sizeof(maxWeight));
+        memcpy(&storedBytes, data + 56, sizeof(storedBytes));
+        memcpy(&damping, data + 64, sizeof(damping));
+        memcpy(&tolerance, data + 72, sizeof(tolerance));
+        memcpy(&iterations, data + 80, sizeof(iterations));
+        // 先排除大到会让 place() 溢出的计数
+        if (version != kVersion || vertices >= UINT32_MAX || edges > size || vocabBytes > size || indexSlots > size) {
+            return false;
+        }
+        // 参数不合理的 PageRank 段当作不存在（段的位置仍按标志计算）
+        place();
+        if (!(damping > 0.0 && damping < 1.0)) { flags &= ~kHasPageRank;
+}
+        return fileBytes == storedBytes && fileBytes == size;
+    }
+};
+
+class Graph {
+private:
+    // 从快照加载时持有文件映射；words 与 csr 可能直接指向映射的页面，所以它最先构造、最后析构
+    shared_ptr<MappedFile> snapshot;
+    WordInterner words;
+    // 上次冻结之后新增的边（按编号对计数），冻结时并入 CSR
+    mutable unordered_map<uint64_t, int> pendingEdges;
+    mutable CsrGraph csr;
+    vector<double> pageRank;
+    PageRankStats pageRankStats;
+    // 增量 PageRank 的状态：上次计算所用的参数、当时的悬挂节点，以及之后出边有变化的源点
+    PageRankOptions rankOptions;
+    vector<bool> rankedDangling;
+    unordered_set<uint32_t> rankTouched;
+    bool rankStale = false;
+    bool incrementalRank = false;
+    // 惰性/后台 PageRank：lazyRank 打开后 getPageRank 在没有结果或结果过期时按 lazyRankOptions 重新计算；
+    // startPageRank 在 rankWorker 线程里计算，rankRunning 在计算结束时清零；
+    // rankCancel 让正在进行的计算在本轮迭代结束后放弃（析构时设置，退出程序不必等它算完）
+    bool lazyRank = false;
+    PageRankOptions lazyRankOptions;
+    mutable thread rankWorker;
+    atomic<bool> rankRunning{false};
+    atomic<bool> rankCancel{false};
+    BridgeCache bridgeCache;
+    // 点对点最短路径的工作区，在查询之间复用；有地标表时改用 ALT 搜索
+    BidirectionalDijkstra<> pathSearch;
+    LandmarkIndex landmarks;
+    LandmarkAStar<> landmarkSearch;
+    YenKShortestPaths<> kPathSearch;
+    // 加权游走的别名表随 CSR 一起作废；单次 randomWalk 复用同一个工作区
+    mutable AliasTables walkTables;
+    WalkScratch walkScratch;
+    unique_ptr<WalkSink> walkSink = make_unique<TruncatingFileWalkSink>();
+    PathSearchStats pathSearchStats;
+
+    // 把 pendingEdges 合并进 CSR；图未变化时什么都不做
+    void ensureFrozen() const {
+        if (csr.vertexCount() == words.size() && pendingEdges.empty()) { return;
+}
+        rebuildCsr();
+    }
+
+    // 重建 CSR：旧的 CSR 边与新增边一起按 (src, dest) 排序后写回
+    void rebuildCsr() const {
+        const size_t V = words.size();
+        vector<pair<uint64_t, int>> edges;
+        edges.reserve(csr.edgeCount() + pendingEdges.size());
+        for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+            for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                edges.emplace_back(edgeKey(u, csr.targets[e]), csr.weights[e]);
+            }
+        }
+        for (const auto& [key, count] : pendingEdges) {
+            edges.emplace_back(key, count);
+        }
+        pendingEdges.clear();
+        sort(edges.begin(), edges.end());
+
+        // 先在普通 vector 里建好各数组，再交给 CSR（旧 CSR 可能直接指向快照文件，不能原地修改）
+        vector<uint64_t> offsets(V + 1, 0);
+        vector<uint32_t> targets;
+        vector<int> weights;
+        targets.reserve(edges.size());
+        weights.reserve(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            auto src = static_cast<uint32_t>(edges[i].first >> 32);
+            auto dest = static_cast<uint32_t>(edges[i].first);
+            // 同一条边可能同时出现在旧 CSR 和 pendingEdges 中，合并计数
+            if (i > 0 && edges[i - 1].first == edges[i].first) {
+                weights.back() += edges[i].second;
+                continue;
+            }
+            offsets[src + 1]++;
+            targets.push_back(dest);
+            weights.push_back(edges[i].second);
+        }
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        // 计数排序构建反向索引；按源点升序遍历，每个目标的来源列表自然有序
+        vector<uint64_t> inOffsets(V + 1, 0);
+        for (uint32_t dest : targets) {
+            inOffsets[dest + 1]++;
+        }
+        partial_sum(inOffsets.begin(), inOffsets.end(), inOffsets.begin());
+        vector<uint32_t> inSources(targets.size());
+        vector<int> inWeights(targets.size());
+        vector<uint64_t> cursor(inOffsets.begin(), inOffsets.end() - 1);
+        for (uint32_t src = 0; src < V; ++src) {
+            for (uint64_t e = offsets[src]; e < offsets[src + 1]; ++e) {
+                uint64_t slot = cursor[targets[e]]++;
+                inSources[slot] = src;
+                inWeights[slot] = weights[e];
+            }
+        }
+
+        CsrGraph built;
+        if (!weights.empty()) {
+            built.maxWeight = *max_element(weights.begin(), weights.end());
+        }
+        built.offsets = move(offsets);
+        built.targets = move(targets);
+        built.weights = move(weights);
+        built.inOffsets = move(inOffsets);
+        built.inSources = move(inSources);
+        built.inWeights = move(inWeights);
+        csr = move(built);
+        walkTables = AliasTables();
+    }
+
+    // 按"入边数 + 1"的累计量把节点切成 parts 段连续区间，返回 parts + 1 个边界，
+    // 使每个线程分到的拉取工作量大致相同
+    static auto partitionVertices(const CsrGraph& g, unsigned parts) -> vector<uint32_t> {
+        const auto V = static_cast<uint32_t>(g.vertexCount());
+        const double total = static_cast<double>(g.edgeCount()) + V;
+        vector<uint32_t> bounds(parts + 1, V);
+        bounds[0] = 0;
+        for (unsigned p = 1; p < parts; ++p) {
+            double goal = total * p / parts;
+            // inOffsets[v] + v 随 v 单调递增，二分查找第一个达到目标的位置
+            uint32_t lo = bounds[p - 1];
+            uint32_t hi = V;
+            while (lo < hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (static_cast<double>(g.inOffsets[mid] + mid) < goal) { lo = mid + 1;
+                } else { hi = mid;
+}
+            }
+            bounds[p] = lo;
+        }
+        return bounds;
+    }
+
+    // 记下计算 PR 时的图状态（节点数与悬挂节点），供增量刷新计算残差
+    void rememberRankedGraph() {
+        const auto& g = getCsr();
+        rankedDangling.assign(g.vertexCount(), false);
+        for (uint32_t v = 0; v < g.vertexCount(); ++v) {
+            rankedDangling[v] = g.outDegree(v) == 0;
+        }
+        rankTouched.clear();
+        rankStale = false;
+    }
+
+    // 把 PR 向量归一化到总和为 1
+    static void normalizeRanks(vector<double>& pr) {
+        double total = accumulate(pr.begin(), pr.end(), 0.0);
+        if (total <= 0.0) { return;
+}
+        for (double& value : pr) { value /= total;
+}
+    }
+
+    // 对连续三轮的结果 x0, x1, x2 逐分量做 Aitken Δ² 外推，结果写回 x2；
+    // 分母过小或外推值不为正的分量保持 x2 不变，最后重新归一化
+    static void aitkenExtrapolate(const vector<double>& x0, const vector<double>& x1, vector<double>& x2) {
+        for (size_t v = 0; v < x2.size(); ++v) {
+            double delta = x2[v] - x1[v];
+            double denom = delta - (x1[v] - x0[v]);
+            if (fabs(denom) < 1e-300) { continue;
+}
+            double extrapolated = x2[v] - delta * delta / denom;
+            if (extrapolated > 0.0 && isfinite(extrapolated)) { x2[v] = extrapolated;
+}
+        }
+        normalizeRanks(x2);
+    }
+
+public:
+    ~Graph() {
+        rankCancel.store(true, memory_order_relaxed);
+        waitPageRank();
+    }
+
+    void addEdge(const string& src, const string& dest) {
+        waitPageRank();
+        addEdge(words.intern(src), words.intern(dest));
+    }
+
+    auto addWord(string_view word) -> uint32_t {
+        waitPageRank();
+        return words.intern(word);
+    }
+
+    // 图的任何修改都先等后台的 PageRank 算完，再把结果标记为过期
+    void addEdge(uint32_t src, uint32_t dest, int count = 1) {
+        waitPageRank();
+        pendingEdges[edgeKey(src, dest)] += count;
+        bridgeCache.touch(src, dest);
+        // 新边可能让距离变短，旧地标表给出的下界不再可靠
+        if (!landmarks.empty()) { landmarks.clear();
+}
+        if (!pageRank.empty()) {
+            rankStale = true;
+            rankTouched.insert(src);
+        }
+    }
+
+    // 冻结图：之后的查询都直接在 CSR 上进行；冻结后仍可以继续 addEdge
+    void freeze() const {
+        ensureFrozen();
+    }
+
+    auto getCsr() const -> const CsrGraph& {
+        ensureFrozen();
+        return csr;
+    }
+
+    auto vertexCount() const -> size_t {
+        return words.size();
+    }
+
+    auto findWord(string_view word) const -> uint32_t {
+        return words.find(word);
+    }
+
+    auto wordOf(uint32_t id) const -> string {
+        return string(words.word(id));
+    }
+
+    // 与 wordOf 相同，但不复制字符串；驻留表只增不删，返回的视图一直有效
+    auto wordView(uint32_t id) const -> string_view {
+        return words.word(id);
+    }
+
+    // 桥接词查询：word1 的出邻居与 word2 的入邻居两个有序列表求交，结果按编号升序追加到 out。
+    // 图已冻结时这是只读操作，可以多线程共享；调用方复用 out 即可避免分配
+    void bridgeIds(uint32_t word1, uint32_t word2, vector<uint32_t>& out) const {
+        const auto& g = getCsr();
+        intersectSorted(g.targets.data() + g.offsets[word1], g.outDegree(word1),
+                        g.inSources.data() + g.inOffsets[word2], g.inDegree(word2), out);
+    }
+
+    // 桥接词查询：单词不存在或没有桥接词时只返回状态，由调用方决定是否需要生成提示信息
+    auto getBridgeWords(string_view word1, string_view word2) -> BridgeResult {
+        uint32_t id1 = words.find(word1);
+        uint32_t id2 = words.find(word2);
+        if (id1 == WordInterner::npos || id2 == WordInterner::npos) {
+            if (id1 == id2) { return {BridgeStatus::MissingBoth};
+}
+            return {id1 == WordInterner::npos ? BridgeStatus::MissingWord1 : BridgeStatus::MissingWord2};
+        }
+        return getBridgeWords(id1, id2);
+    }
+
+    auto getBridgeWords(uint32_t word1, uint32_t word2) -> BridgeResult {
+        return getBridgeWords(word1, word2, bridgeCache);
+    }
+
+    // 同上，但结果缓存在调用方提供的 cache 里：多线程批量查询时每个线程各用一个缓存。
+    // 这样的缓存收不到 addEdge 的失效通知，只能在图不变的期间使用
+    auto getBridgeWords(uint32_t word1, uint32_t word2, BridgeCache& cache) const -> BridgeResult {
+        const vector<uint32_t>* mids = cache.find(word1, word2);
+        if (mids == nullptr) {
+            vector<uint32_t> found;
+            bridgeIds(word1, word2, found);
+            mids = &cache.insert(word1, word2, move(found));
+        }
+        if (mids->empty()) { return {BridgeStatus::NoBridge};
+}
+        return {BridgeStatus::Found, mids->data(), mids->size()};
+    }
+
+    // 桥接词缓存的内存上限（字节）
+    void setBridgeCacheCapacity(size_t bytes) {
+        bridgeCache.setCapacity(bytes);
+    }
+
+    auto getBridgeCacheStats() const -> BridgeCacheStats {
+        return bridgeCache.stats();
+    }
+
+    auto shortestPath(const string& src, const string& dest) -> vector<string> {
+        uint32_t s = words.find(src);
+        uint32_t t = words.find(dest);
+        vector<string> path;
+        if (s == WordInterner::npos || t == WordInterner::npos) { return path;
+}
+
+        vector<uint32_t> ids;
+        if (landmarks.empty()) {
+            ids = pathSearch.search(getCsr(), s, t);
+            pathSearchStats = pathSearch.stats();
+        } else {
+            ids = landmarkSearch.search(getCsr(), landmarks, s, t);
+            pathSearchStats = landmarkSearch.stats();
+        }
+        for (uint32_t id : ids) {
+            path.push_back(wordOf(id));
+        }
+        return path;
+    }
+
+    // 前 k 条无环最短路径，按长度升序（长度相同时按发现顺序），任一单词不在图中时返回空
+    auto kShortestPaths(const string& src, const string& dest, size_t k) -> vector<RankedPath> {
+        uint32_t s = words.find(src);
+        uint32_t t = words.find(dest);
+        if (s == WordInterner::npos || t == WordInterner::npos) { return {};
+}
+        return kPathSearch.search(getCsr(), s, t, k);
+    }
+
+    // 最近一次 shortestPath 查询的搜索量
+    auto getPathSearchStats() const -> PathSearchStats {
+        return pathSearchStats;
+    }
+
+    // ALT 预处理：选 count 个地标并求出到它们的正反向距离，之后的 shortestPath 改用 A*。
+    // 之后再 addEdge 会使地标表作废，回到双向 Dijkstra
+    void buildLandmarks(unsigned count) {
+        landmarks.build(getCsr(), count);
+    }
+
+    auto landmarkCount() const -> size_t {
+        return landmarks.size();
+    }
+
+    auto requestedLandmarkCount() const -> unsigned {
+        return landmarks.requestedSize();
+    }
+
+    // 地标表与图指纹一起保存，重启后可以直接加载；图变化后指纹不符，加载失败
+    auto saveLandmarks(const string& path) const -> bool {
+        return landmarks.save(path, csrFingerprint(getCsr()));
+    }
+
+    auto loadLandmarks(const string& path) -> bool {
+        const auto& g = getCsr();
+        return landmarks.load(path, csrFingerprint(g), g.vertexCount());
+    }
+
+    // 把词表、CSR 和 PageRank（已经算过且之后图没有变化时）写成快照，之后 loadSnapshot 可以直接映射使用
+    auto saveSnapshot(const string& path) const -> bool {
+        waitPageRank();  // 后台计算写完 pageRank 之后再读
+        const auto& g = getCsr();
+        const size_t V = words.size();
+        vector<uint64_t> wordOffsets(V + 1, 0);
+        for (uint32_t id = 0; id < V; ++id) {
+            wordOffsets[id + 1] = wordOffsets[id] + words.word(id).size();
+        }
+        vector<uint32_t> index = words.lookupTable();
+
+        SnapshotLayout layout;
+        layout.flags = pageRank.size() == V && !rankStale ? SnapshotLayout::kHasPageRank : 0;
+        layout.vertices = V;
+        layout.edges = g.edgeCount();
+        layout.vocabBytes = wordOffsets[V];
+        layout.indexSlots = index.size();
+        layout.maxWeight = g.maxWeight;
+        layout.damping = rankOptions.damping;
+        layout.tolerance = rankOptions.tolerance;
+        layout.iterations = pageRankStats.iterations;
+        layout.place();
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) { return false;
+}
+        const char zeros[8] = {};
+        auto section = [&](const void* data, uint64_t bytes) {
+            out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+            out.write(zeros, static_cast<streamsize>(SnapshotLayout::padding(bytes)));
+        };
+        out << layout.header();
+        section(wordOffsets.data(), (V + 1) * sizeof(uint64_t));
+        for (uint32_t id = 0; id < V; ++id) {
+            out << words.word(id);
+        }
+        out.write(zeros, static_cast<streamsize>(SnapshotLayout::padding(layout.vocabBytes)));
+        section(index.data(), index.size() * sizeof(uint32_t));
+        section(g.offsets.data(), (V + 1) * sizeof(uint64_t));
+        section(g.targets.data(), g.edgeCount() * sizeof(uint32_t));
+        section(g.weights.data(), g.edgeCount() * sizeof(int));
+        section(g.inOffsets.data(), (V + 1) * sizeof(uint64_t));
+        section(g.inSources.data(), g.edgeCount() * sizeof(uint32_t));
+        section(g.inWeights.data(), g.edgeCount() * sizeof(int));
+        if (layout.hasPageRank()) { section(pageRank.data(), V * sizeof(double));
+}
+        return static_cast<bool>(out);
+    }
+
+    // 以只读方式映射快照：词表、查找表与 CSR 直接使用映射的页面，不复制也不重建，
+    // 同一主机上的多个进程共享同一份页缓存；只有 PageRank 复制到堆上（之后可能被重新计算）。
+    // 之后仍可 addEdge，新边会在下次冻结时与映射的 CSR 合并成新的 CSR。
+    // 只能在空图上调用；文件不是快照或内容不一致时返回 false，图保持为空
+    auto loadSnapshot(const string& path) -> bool {
+        if (words.size() != 0 || !pendingEdges.empty()) { return false;
+}
+        auto file = make_shared<MappedFile>(path);
+        SnapshotLayout layout;
+        if (!file->isOpen() || !layout.parse(file->data(), file->size())) { return false;
+}
+        const char* base = file->data();
+        const uint64_t V = layout.vertices;
+        const uint64_t E = layout.edges;
+        const auto* wordOffsets = reinterpret_cast<const uint64_t*>(base + layout.wordOffsets);
+        const auto* index = reinterpret_cast<const uint32_t*>(base + layout.index);
+        const auto* offsets = reinterpret_cast<const uint64_t*>(base + layout.offsets);
+        const auto* inOffsets = reinterpret_cast<const uint64_t*>(base + layout.inOffsets);
+        // 只做 O(1) 的一致性检查，逐项校验会抵消映射加载的好处
+        if (wordOffsets[0] != 0 || wordOffsets[V] != layout.vocabBytes || offsets[0] != 0 || offsets[V] != E ||
+            inOffsets[0] != 0 || inOffsets[V] != E || layout.indexSlots <= V ||
+            (layout.indexSlots & (layout.indexSlots - 1)) != 0) {
+            return false;
+        }
+        file->advise(MADV_RANDOM);
+
+        words.attach(base + layout.vocab, ReadOnlyArray<uint64_t>(wordOffsets, V + 1),
+                     ReadOnlyArray<uint32_t>(index, layout.indexSlots));
+        CsrGraph mapped;
+        mapped.offsets = ReadOnlyArray<uint64_t>(offsets, V + 1);
+        mapped.targets = ReadOnlyArray<uint32_t>(reinterpret_cast<const uint32_t*>(base + layout.targets), E);
+        mapped.weights = ReadOnlyArray<int>(reinterpret_cast<const int*>(base + layout.weights), E);
+        mapped.inOffsets = ReadOnlyArray<uint64_t>(inOffsets, V + 1);
+        mapped.inSources = ReadOnlyArray<uint32_t>(reinterpret_cast<const uint32_t*>(base + layout.inSources), E);
+        mapped.inWeights = ReadOnlyArray<int>(reinterpret_cast<const int*>(base + layout.inWeights), E);
+        mapped.maxWeight = layout.maxWeight;
+        csr = move(mapped);
+        walkTables = AliasTables();
+        // TF-IDF 随机跳转的 PageRank（llm_1 写的快照）与这里的算法不同，不能直接使用。
+        // 载入的结果作为增量刷新的基准，之后 addEdge 再 updatePageRank 时从它出发
+        if (layout.hasPageRank() && !layout.tfidfTeleport()) {
+            const auto* rank = reinterpret_cast<const double*>(base + layout.pageRank);
+            pageRank.assign(rank, rank + V);
+            rankOptions.damping = layout.damping;
+            rankOptions.tolerance = layout.tolerance;
+            pageRankStats.iterations = layout.iterations;
+            rememberRankedGraph();
+        }
+        snapshot = move(file);
+        return true;
+    }
+
+    auto hasPageRank() const -> bool {
+        waitPageRank();
+        return !pageRank.empty();
+    }
+
+    // 一次 Dijkstra 求出从 src 到所有节点的最短路径树；src 不在图中时返回空树
+    auto shortestPathTree(const string& src) const -> ShortestPathTree {
+        ShortestPathTree tree;
+        uint32_t s = words.find(src);
+        if (s != WordInterner::npos) {
+            runDijkstra(getCsr(), s, tree);
+        }
+        return tree;
+    }
+
+    void calculatePageRank(double damping = 0.85, int iterations = 100) {
+        PageRankOptions options;
+        options.damping = damping;
+        options.maxIterations = iterations;
+        calculatePageRank(options);
+    }
+
+    void calculatePageRank(const PageRankOptions& options) {
+        waitPageRank();
+        runPageRank(options);
+    }
+
+    // 在后台计算 PageRank 并立即返回，同时按 options 打开惰性模式（见 setLazyPageRank）。
+    // 之后查询 PageRank 或修改图都会先等这次计算结束
+    void startPageRank(const PageRankOptions& options) {
+        waitPageRank();
+        setLazyPageRank(options);
+        ensureFrozen();  // 先在当前线程冻结，后台线程与菜单上的查询都只读 CSR
+        rankRunning = true;
+        rankWorker = thread([this, options] {
+            runPageRank(options);
+            rankRunning.store(false, memory_order_release);
+        });
+    }
+
+    // 等待后台的 PageRank 计算结束；没有在计算时立即返回
+    void waitPageRank() const {
+        if (rankWorker.joinable()) { rankWorker.join();
+}
+    }
+
+    // 打开惰性模式：getPageRank 在还没有结果、或 addEdge 让结果过期时按 options 重新计算（有旧结果时热启动）。
+    // 同时打开增量刷新时优先走增量路径
+    void setLazyPageRank(const PageRankOptions& options) {
+        lazyRank = true;
+        lazyRankOptions = options;
+    }
+
+    // 不等待后台计算，可以在菜单上随时显示
+    auto pageRankStatus() const -> PageRankStatus {
+        if (rankRunning.load(memory_order_acquire)) { return PageRankStatus::Computing;
+}
+        if (pageRank.empty()) { return PageRankStatus::NotComputed;
+}
+        return rankStale || pageRank.size() != words.size() ? PageRankStatus::Stale : PageRankStatus::Ready;
+    }
+
+    // 结果过期后 getPageRank 是否会自动刷新（惰性模式或增量刷新打开时）；否则要重新调用 calculatePageRank
+    auto refreshesPageRankOnQuery() const -> bool {
+        return lazyRank || incrementalRank;
+    }
+
+private:
+    void runPageRank(const PageRankOptions& options) {
+        // Step 1: 所有单词（包括只作为目标出现的单词）都是图中的节点
+        const auto& g = getCsr();
+        const size_t V = g.vertexCount();
+        const double N = V;
+        const double damping = options.damping;
+        const double teleport = (1.0 - damping) / N;
+        pageRankStats = PageRankStats();
+        if (V == 0) {
+            pageRank.clear();
+            return;
+        }
+        
+        // Step 2: 初始化PR值为 1/N；热启动时沿用上一次的结果，新节点取 1/N 后整体归一化
+        vector<double> pr(V, 1.0 / N);
+        if (options.warmStart && !pageRank.empty()) {
+            copy(pageRank.begin(), pageRank.begin() + static_cast<ptrdiff_t>(min(pageRank.size(), V)), pr.begin());
+            normalizeRanks(pr);
+        }
+        vector<double> newPr(V);
+        vector<double> share(V);  // 每个节点沿每条出边分出去的 PR(src)/出度
+        vector<double> older;     // Aitken 外推用到的前两轮结果
+        vector<double> old;
+    
+        // Step 3: 迭代计算，每轮 O(V+E)，残差低于阈值时提前结束。
+        // 多线程时按入边数把节点切成连续区间，每个线程只写自己区间内的 share/newPr；
+        // 悬挂总和与残差先按线程求部分和，再按线程序号顺序相加，结果不受调度影响。
+        // Gauss-Seidel 依赖逐节点的顺序更新，总是单线程运行。
+        const bool gaussSeidel = options.method == PageRankMethod::GaussSeidel;
+        const unsigned threads = gaussSeidel ? 1 : static_cast<unsigned>(min<size_t>(max(options.threads, 1u), V));
+        const vector<uint32_t> ranges = partitionVertices(g, threads);
+        vector<double> danglingParts(threads);
+        vector<double> residualParts(threads);
+        Barrier barrier(threads);
+        bool stop = false;
+
+        runThreads(threads, [&](unsigned t) {
+            const uint32_t begin = ranges[t];
+            const uint32_t end = ranges[t + 1];
+            for (int i = 0; i < options.maxIterations; ++i) {
+                // 计算悬挂节点的PR总和（出度为0的节点），同时算出各节点的出边份额
+                double dangling = 0.0;
+                for (uint32_t node = begin; node < end; ++node) {
+                    size_t degree = g.outDegree(node);
+                    if (degree == 0) {
+                        dangling += pr[node];
+                        share[node] = 0.0;
+                    } else {
+                        share[node] = pr[node] / degree;
+                    }
+                }
+                danglingParts[t] = dangling;
+                barrier.arriveAndWait();
+                double danglingSum = accumulate(danglingParts.begin(), danglingParts.end(), 0.0);
+    
+                // 计算每个节点的新PR值：沿反向索引只拉取真正指向它的来源节点
+                double residual = 0.0;
+                for (uint32_t node = begin; node < end; ++node) {
+                    double sumIn = 0.0;
+                    for (uint64_t e = g.inOffsets[node]; e < g.inOffsets[node + 1]; ++e) {
+                        sumIn += share[g.inSources[e]];
+                    }
+
+                    // 计算新PR值（包含阻尼因子和悬挂节点均分）
+                    double value = teleport + damping * (sumIn + danglingSum / N);
+                    residual += fabs(value - pr[node]);
+                    if (gaussSeidel) {
+                        // 原地更新，后面的节点立即用上新的出边份额和悬挂总和
+                        size_t degree = g.outDegree(node);
+                        if (degree == 0) {
+                            danglingSum += value - pr[node];
+                        } else {
+                            share[node] = value / degree;
+                        }
+                        pr[node] = value;
+                    } else {
+                        newPr[node] = value;
+                    }
+                }
+                residualParts[t] = residual;
+                barrier.arriveAndWait();
+
+                // 0 号线程负责交换缓冲区、外推和收敛判断，其余线程在屏障处等待
+                if (t == 0) {
+                    if (!gaussSeidel) {
+                        if (options.aitkenEvery > 0) {
+                            older.swap(old);
+                            old = pr;
+                        }
+                        swap(pr, newPr); // 更新PR值
+                        if (options.aitkenEvery > 0 && (i + 1) % options.aitkenEvery == 0 && older.size() == V) {
+                            aitkenExtrapolate(older, old, pr);
+                            older.clear();
+                            old.clear();
+                        }
+                    }
+                    double total = accumulate(residualParts.begin(), residualParts.end(), 0.0);
+                    pageRankStats.iterations = i + 1;
+                    pageRankStats.residuals.push_back(total);
+                    if (options.tolerance > 0.0 && total < options.tolerance) {
+                        pageRankStats.converged = true;
+                        stop = true;
+                    }
+                    if (rankCancel.load(memory_order_relaxed)) { stop = true;
+}
+                }
+                barrier.arriveAndWait();
+                if (stop) { break;
+}
+            }
+        });
+    
+        // 保存结果到成员变量；被取消的计算没有收敛，丢弃
+        if (rankCancel.load(memory_order_relaxed)) { return;
+}
+        pageRank = move(pr);
+        rankOptions = options;
+        rememberRankedGraph();
+    }
+
+public:
+
+    auto getPageRankStats() const -> const PageRankStats& {
+        waitPageRank();
+        return pageRankStats;
+    }
+
+    // 增量刷新 PageRank：只从 addEdge 触及的源点、它们的出邻居和新节点出发做残差推送（push）。
+    // 节点数变化、悬挂节点变化会给所有节点带来同样大小的残差，这部分不逐点推送，
+    // 而是利用"均匀残差的解与 PR 向量本身成正比"把整个向量缩放一次消去。
+    // 推送工作量超出预算时退回热启动的完整迭代。返回 true 表示走的是增量路径。
+    auto updatePageRank() -> bool {
+        if (!rankStale) { return true;
+}
+        const auto& g = getCsr();
+        const size_t V = g.vertexCount();
+        const size_t oldV = rankedDangling.size();
+        const double d = rankOptions.damping;
+        const double N0 = oldV;
+        const double N1 = V;
+        const double threshold = (rankOptions.tolerance > 0.0 ? rankOptions.tolerance : 1e-10) / N1;
+        vector<double>& x = pageRank;
+        x.resize(V, 0.0);
+
+        double oldDangling = 0.0;
+        double newDangling = 0.0;
+        for (uint32_t v = 0; v < V; ++v) {
+            if (v < oldV && rankedDangling[v]) { oldDangling += x[v];
+}
+            if (g.outDegree(v) == 0) { newDangling += x[v];
+}
+        }
+        // 未受影响节点的残差整体偏移量
+        double uniform = (1.0 - d) * (1.0 / N1 - 1.0 / N0) + d * (newDangling / N1 - oldDangling / N0);
+
+        vector<double> residual(V, 0.0);
+        vector<char> queued(V, 0);
+        vector<uint32_t> affected;
+        auto addAffected = [&](uint32_t v) {
+            if (queued[v] == 0) {
+                queued[v] = 1;
+                affected.push_back(v);
+            }
+        };
+        for (uint32_t u : rankTouched) {
+            addAffected(u);
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e) { addAffected(g.targets[e]);
+}
+        }
+        for (auto v = static_cast<uint32_t>(oldV); v < V; ++v) { addAffected(v);
+}
+
+        // 受影响节点的残差按新图精确计算，扣掉均匀部分后只剩局部分量
+        deque<uint32_t> queue;
+        for (uint32_t w : affected) {
+            double sumIn = 0.0;
+            for (uint64_t e = g.inOffsets[w]; e < g.inOffsets[w + 1]; ++e) {
+                uint32_t u = g.inSources[e];
+                sumIn += x[u] / g.outDegree(u);
+            }
+            residual[w] = (1.0 - d) / N1 + d * (sumIn + newDangling / N1) - x[w] - uniform;
+            queued[w] = 0;
+            if (fabs(residual[w]) > threshold) {
+                queued[w] = 1;
+                queue.push_back(w);
+            }
+        }
+
+        // 均匀残差 s·1 对应的解约为 α = s·N/(1-d) 倍的 PR 向量：把 x 缩放 (1+α) 后
+        // 剩下的均匀残差是 α·s，局部残差也随之缩放，重复几次即可把均匀部分压到阈值以下
+        auto absorbUniform = [&]() {
+            while (fabs(uniform) > threshold) {
+                double alpha = uniform * N1 / (1.0 - d);
+                for (uint32_t v = 0; v < V; ++v) {
+                    x[v] *= 1.0 + alpha;
+                    residual[v] *= 1.0 + alpha;
+                }
+                uniform *= alpha;
+            }
+        };
+        absorbUniform();
+
+        // 与完整迭代的停止条件一致：残差的 L1 总量（含均匀部分）低于 tolerance 即可停止，
+        // 不必把每个节点都推到逐点阈值以下
+        const double tolerance = rankOptions.tolerance > 0.0 ? rankOptions.tolerance : 1e-10;
+        double pending = 0.0;
+        for (double r : residual) { pending += fabs(r);
+}
+        // 预算取退回时那次热启动完整迭代的代价：残差每轮至少缩小 d 倍，从本次改动带来的残差
+        // 降到 tolerance 所需的轮数，且不超过上次从头计算用的轮数。小而稠密的图上残差很快扩散到
+        // 全图，推送与完整迭代的代价相当，只有推送超出这个代价时退回才更便宜
+        const double initial = pending + N1 * fabs(uniform);
+        double sweeps = pageRankStats.iterations;
+        if (initial > tolerance) { sweeps = min(sweeps, ceil(log(tolerance / initial) / log(d)));
+}
+        const double budget = max(sweeps, 1.0) * static_cast<double>(g.edgeCount() + V);
+        double work = 0.0;
+        while (!queue.empty() && pending + N1 * fabs(uniform) >= tolerance) {
+            uint32_t v = queue.front();
+            queue.pop_front();
+            queued[v] = 0;
+            double delta = residual[v];
+            x[v] += delta;
+            residual[v] = 0.0;
+            pending -= fabs(delta);
+            size_t degree = g.outDegree(v);
+            if (degree == 0) {
+                // 悬挂节点的推送均匀分给所有节点
+                uniform += d * delta / N1;
+                continue;
+            }
+            double share = d * delta / degree;
+            for (uint64_t e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+                uint32_t w = g.targets[e];
+                pending -= fabs(residual[w]);
+                residual[w] += share;
+                pending += fabs(residual[w]);
+                if (queued[w] == 0 && fabs(residual[w]) > threshold) {
+                    queued[w] = 1;
+                    queue.push_back(w);
+                }
+            }
+            work += static_cast<double>(degree);
+            if (work > budget) {
+                PageRankOptions options = rankOptions;
+                options.warmStart = true;
+                calculatePageRank(options);
+                return false;
+            }
+        }
+        absorbUniform();
+
+        rememberRankedGraph();
+        return true;
+    }
+
+    // 打开后 getPageRank 会在图变化后先做增量刷新，保证返回的值是最新的
+    void setIncrementalPageRank(bool enabled) {
+        incrementalRank = enabled;
+    }
+
+    auto getPageRank(const string& word) -> double {
+        waitPageRank();
+        if (incrementalRank && rankStale) {
+            updatePageRank();
+        } else if (lazyRank && (rankStale || pageRank.size() != words.size())) {
+            PageRankOptions options = lazyRankOptions;
+            options.warmStart = !pageRank.empty();
+            runPageRank(options);
+        }
+        uint32_t id = words.find(word);
+        return id < pageRank.size() ? pageRank[id] : 0.0;
+    }
+
+    // randomWalk 的结果交给 sink；传入空指针表示丢弃结果。默认每次截断重写 random_walk.txt
+    void setWalkSink(unique_ptr<WalkSink> sink) {
+        walkSink = sink ? move(sink) : make_unique<NullWalkSink>();
+    }
+
+    auto getWalkSink() -> WalkSink& {
+        return *walkSink;
+    }
+
+    // 加权游走用的别名表，图变化后第一次调用时重建。多线程游走前应先调用一次，之后只读
+    auto getWalkTables() const -> const AliasTables& {
+        const auto& g = getCsr();
+        if (walkTables.threshold.size() != g.edgeCount()) {
+            walkTables.build(g);
+        }
+        return walkTables;
+    }
+
+    // 从 start 出发随机游走，走到没有出边的节点、即将重复走一条边或节点数达到 maxLength 时停止，
+    // 节点序列写入 scratch.path。
+    // weighted 为 true 时按共现次数加权选边（需要先调用 getWalkTables()）。只读取 CSR 与别名表，
+    // 各线程使用自己的 rng 和 scratch 时可以并发调用
+    void walk(uint32_t start, bool weighted, SplitMix64& rng, WalkScratch& scratch,
+              size_t maxLength = SIZE_MAX) const {
+        biasedWalk(start, 1.0, 1.0, weighted, rng, scratch, maxLength);
+    }
+
+    // node2vec 式的二阶游走（p、q 须为正数）：上一步从 prev 走到 current 后，候选 x 的偏置为 1/p（x 就是 prev）、
+    // 1（prev -> x 也是一条边）或 1/q（其余），再乘上 walk 的一阶选边概率 π(x)。不物化每条边的转移表，
+    // 而是按 π 提议 x、以 偏置 / 包络 的概率接受（拒绝采样）；prev -> x 是否存在在 prev 的有序出边里二分查找。
+    // 每次提议 O(1)、判断 O(log 出度)，高频词的出度再大也不需要逐边计算。
+    // 包络只取 1 与 1/q 中的较大者：p 较小时返回边的偏置超出包络，超出的 (1/p - 包络) × π(prev) 单独作为一块
+    // 区域，每轮先按它占的面积比例直接选中 prev，这样小 p 不会拉低其余候选的接受率。
+    // 停止条件与 walk 相同；p = q = 1 时与 walk 完全一致（包括随机数的消耗）
+    void biasedWalk(uint32_t start, double p, double q, bool weighted, SplitMix64& rng, WalkScratch& scratch,
+                    size_t maxLength = SIZE_MAX) const {
+        const auto& g = getCsr();
+        const double returnBias = 1.0 / p;
+        const double outBias = 1.0 / q;
+        const double envelope = max(1.0, outBias);
+        const bool firstOrder = returnBias == 1.0 && outBias == 1.0;
+        scratch.visited.clear();
+        scratch.path.clear();
+        scratch.path.push_back(start);
+        uint32_t previous = WordInterner::npos;
+        uint32_t current = start;
+        while (scratch.path.size() < maxLength) {
+            size_t degree = g.outDegree(current);
+            if (degree == 0) { break;
+}
+            const uint64_t base = g.offsets[current];
+            double outlier = 0.0;
+            if (!firstOrder && returnBias > envelope && previous != WordInterner::npos) {
+                size_t back = g.findEdge(current, previous);
+                if (back != g.edgeCount()) {
+                    double backProbability = weighted ? g.weights[back] / walkTables.totals[current] : 1.0 / degree;
+                    outlier = (returnBias - envelope) * backProbability;
+                }
+            }
+            uint32_t next = 0;
+            while (true) {
+                if (outlier > 0.0 && rng.uniform() * (envelope + outlier) < outlier) {
+                    next = previous;
+                    break;
+                }
+                uint64_t pick = rng.below(degree);
+                if (weighted) {
+                    pick = walkTables.sample(base, pick, static_cast<uint32_t>(rng.next() >> 32));
+                }
+                next = g.targets[base + pick];
+                // 第一步还没有上一跳，直接按一阶分布
+                if (firstOrder || previous == WordInterner::npos) { break;
+}
+                double bias = outBias;
+                if (next == previous) { bias = min(returnBias, envelope);
+                } else if (g.findEdge(previous, next) != g.edgeCount()) { bias = 1.0;
+}
+                if (bias >= envelope || rng.uniform() * envelope < bias) { break;
+}
+            }
+            if (!scratch.visited.insert(edgeKey(current, next))) { break;
+}
+            previous = current;
+            current = next;
+            scratch.path.push_back(current);
+        }
+    }
+
+    auto randomWalk(bool weighted = false) -> string {
+        return biasedRandomWalk(1.0, 1.0, weighted);
+    }
+
+    // 从随机选取的、有出边的节点出发做一次 biasedWalk，结果交给游走 sink 并返回（单词之间以空格分隔）
+    auto biasedRandomWalk(double p, double q, bool weighted = false) -> string {
+        const auto& g = getCsr();
+        if (g.edgeCount() == 0) { return "";
+}
+        static random_device rd;
+        static SplitMix64 rng((static_cast<uint64_t>(rd()) << 32) | rd());
+        if (weighted) { getWalkTables();
+}
+        // 只在有出边的节点中均匀选起点（拒绝采样）：从只作为句尾出现的词出发只能得到一个词。
+        // 图里至少有一条边，循环一定会结束；多数节点都有出边时期望只需抽一两次
+        auto start = static_cast<uint32_t>(rng.below(g.vertexCount()));
+        while (g.outDegree(start) == 0) { start = static_cast<uint32_t>(rng.below(g.vertexCount()));
+}
+        biasedWalk(start, p, q, weighted, rng, walkScratch);
+
+        string result;
+        for (auto id : walkScratch.path) {
+            result += words.word(id);
+            result += ' ';
+        }
+        walkSink->write(result);
+        return result;
+    }
+};
+
+// 字母分类与小写折叠内核：一次处理 64 字节，返回"是 ASCII 字母"的位掩码（第 i 位对应第 i 个字节），
+// 并把每个字节的 c | 0x20 写入 folded。对字母而言这正是 tolower，非字母字节的折叠结果不会被使用。
+using ClassifyBlockFn = uint64_t (*)(const char* in, char* folded);
+
+inline auto classifyBlockScalar(const char* in, char* folded) -> uint64_t {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) {
+        auto lower = static_cast<unsigned char>(in[i] | 0x20);
+        folded[i] = static_cast<char>(lower);
+        if (lower >= 'a' && lower <= 'z') { mask |= uint64_t{1} << i;
+}
+    }
+    return mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// SSE2 是 x86-64 的基线指令集：(c | 0x20) - 'a' 按无符号比较 <= 25 即为字母
+inline auto classifyBlockSse2(const char* in, char* folded) -> uint64_t {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i letterA = _mm_set1_epi8('a');
+    const __m128i span = _mm_set1_epi8(25);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lower = _mm_or_si128(bytes, caseBit);
+        __m128i offset = _mm_sub_epi8(lower, letterA);
+        __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(folded + i), lower);
+        mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(isAlpha))) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+inline auto classifyBlockAvx2(const char* in, char* folded) -> uint64_t {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i letterA = _mm256_set1_epi8('a');
+    const __m256i span = _mm256_set1_epi8(25);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i lower = _mm256_or_si256(bytes, caseBit);
+        __m256i offset = _mm256_sub_epi8(lower, letterA);
+        __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span), offset);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(folded + i), lower);
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(isAlpha))) << i;
+    }
+    return mask;
+}
+#endif
+
+// 运行时按 CPU 能力选择内核，非 x86 平台使用标量版本
+inline auto selectClassifyBlock() -> ClassifyBlockFn {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return classifyBlockAvx2;
+}
+#if defined(__SSE2__)
+    return classifyBlockSse2;
+#endif
+#endif
+    return classifyBlockScalar;
+}
+
+class TextProcessor {
+public:
+    // 逐个产出小写单词：非 ASCII 字母一律视为分隔符（与按 C locale 的 isalpha/tolower 逐字符处理一致）。
+    // 每次分类 64 字节得到字母位掩码，再用 ctz 在掩码里找单词边界；完全落在块内的单词
+    // 直接以指向折叠缓冲区的 string_view 交给回调，跨块的单词才拼接到 carry 中。
+    // 回调返回后视图即失效。
+    template <class OnWord>
+    static void forEachWord(const char* data, size_t size, OnWord&& onWord) {
+        static const ClassifyBlockFn classify = selectClassifyBlock();
+        alignas(64) char folded[64];
+        alignas(64) char tail[64];
+        string carry;
+
+        for (size_t i = 0; i < size; i += 64) {
+            const char* block = data + i;
+            size_t length = min<size_t>(64, size - i);
+            if (length < 64) {
+                // 末尾不足 64 字节时补 0（0 不是字母），掩码里多出来的位自然为 0
+                memcpy(tail, block, length);
+                memset(tail + length, 0, 64 - length);
+                block = tail;
+            }
+            uint64_t alpha = classify(block, folded);
+
+            unsigned pos = 0;
+            if (!carry.empty()) {
+                // 上一块结尾的单词延续到本块开头
+                unsigned run = ~alpha == 0 ? 64 : static_cast<unsigned>(__builtin_ctzll(~alpha));
+                carry.append(folded, run);
+                if (run == 64) { continue;
+}
+                onWord(string_view(carry));
+                carry.clear();
+                pos = run;
+            }
+            while (pos < 64) {
+                uint64_t rest = alpha & (~uint64_t{0} << pos);
+                if (rest == 0) { break;
+}
+                auto start = static_cast<unsigned>(__builtin_ctzll(rest));
+                uint64_t gaps = ~alpha & (~uint64_t{0} << start);
+                if (gaps == 0) {
+                    // 单词一直延伸到块尾，留给下一块继续
+                    carry.assign(folded + start, 64 - start);
+                    break;
+                }
+                auto end = static_cast<unsigned>(__builtin_ctzll(gaps));
+                onWord(string_view(folded + start, end - start));
+                pos = end;
+            }
+        }
+        if (!carry.empty()) { onWord(string_view(carry));
+}
+    }
+
+    // 逐字符的参考实现，用于校验向量化版本和做基准对比
+    template <class OnWord>
+    static void forEachWordScalar(const char* data, size_t size, OnWord&& onWord) {
+        string word;
+        for (size_t i = 0; i < size; ++i) {
+            auto c = static_cast<unsigned char>(data[i]);
+            if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') {
+                word.push_back(static_cast<char>(c | 0x20));
+            } else if (!word.empty()) {
+                onWord(string_view(word));
+                word.clear();
+            }
+        }
+        if (!word.empty()) { onWord(string_view(word));
+}
+    }
+
+    // 以内存映射方式流式读取文件；文件无法打开时返回 false
+    template <class OnWord>
+    static auto forEachWord(const string& filename, OnWord&& onWord) -> bool {
+        MappedFile file(filename);
+        if (!file.isOpen()) { return false;
+}
+        forEachWord(file.data(), file.size(), onWord);
+        return true;
+    }
+
+    // 直接把相邻单词对写入图中，峰值内存只和词表大小有关，与语料大小无关。
+    // 语料按字节区间切成若干块并行分词，每个线程维护自己的词表和边计数；
+    // 块边界只落在单词之间，相邻块首尾单词组成的边在合并时补上。
+    // 按块顺序合并局部词表时编号仍按首次出现顺序分配，所以结果与串行构建完全相同。
+    static auto buildGraph(const string& filename, Graph& graph,
+                           unsigned threads = thread::hardware_concurrency()) -> bool {
+        MappedFile file(filename);
+        if (!file.isOpen()) { return false;
+}
+        // 快照文件（见 Graph::saveSnapshot）直接映射加载，不再分词
+        if (SnapshotLayout::matches(file.data(), file.size())) { return graph.loadSnapshot(filename);
+}
+        const char* data = file.data();
+        const size_t size = file.size();
+        // 每块至少 1 MiB，小文件不值得开线程
+        const size_t chunks = max<size_t>(1, min<size_t>(max(threads, 1u), size >> 20));
+
+        auto isLetter = [](char c) {
+            auto lower = static_cast<unsigned char>(c | 0x20);
+            return lower >= 'a' && lower <= 'z';
+        };
+        vector<size_t> bounds(chunks + 1, size);
+        bounds[0] = 0;
+        for (size_t i = 1; i < chunks; ++i) {
+            size_t pos = max(bounds[i - 1], size / chunks * i);
+            while (pos < size && isLetter(data[pos])) { ++pos;
+}
+            bounds[i] = pos;
+        }
+
+        struct Chunk {
+            WordInterner words;
+            unordered_map<uint64_t, int> edges;
+            uint32_t first = WordInterner::npos;
+            uint32_t last = WordInterner::npos;
+        };
+        vector<Chunk> parts(chunks);
+        runThreads(static_cast<unsigned>(chunks), [&](unsigned t) {
+            Chunk& part = parts[t];
+            forEachWord(data + bounds[t], bounds[t + 1] - bounds[t], [&](string_view word) {
+                uint32_t id = part.words.intern(word);
+                if (part.last != WordInterner::npos) { part.edges[edgeKey(part.last, id)]++;
+                } else { part.first = id;
+}
+                part.last = id;
+            });
+        });
+
+        uint32_t prev = WordInterner::npos;
+        vector<uint32_t> toGlobal;
+        for (auto& part : parts) {
+            if (part.first == WordInterner::npos) { continue;
+}
+            toGlobal.resize(part.words.size());
+            for (uint32_t id = 0; id < part.words.size(); ++id) {
+                toGlobal[id] = graph.addWord(part.words.word(id));
+            }
+            // 拼接：上一块的最后一个单词指向本块的第一个单词
+            if (prev != WordInterner::npos) { graph.addEdge(prev, toGlobal[part.first]);
+}
+            for (const auto& [key, count] : part.edges) {
+                graph.addEdge(toGlobal[key >> 32], toGlobal[static_cast<uint32_t>(key)], count);
+            }
+            prev = toGlobal[part.last];
+            part = Chunk();
+        }
+        return true;
+    }
+
+    static auto processText(const string& filename) -> vector<string> {
+        vector<string> words;
+        forEachWord(filename, [&](string_view word) { words.emplace_back(word); });
+        return words;
+    }
+};
+
+// DOT 渲染队列：后台最多 maxWorkers 个 dot 进程并发，提交后立即返回，不阻塞菜单；
+// wait() 等待已提交的任务全部完成，析构时也会等待
+class DotRenderer {
+public:
+    explicit DotRenderer(unsigned maxWorkers) : maxWorkers(max(maxWorkers, 1u)) {}
+
+    ~DotRenderer() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) { worker.join();
+}
+    }
+
+    DotRenderer(const DotRenderer&) = delete;
+    auto operator=(const DotRenderer&) -> DotRenderer& = delete;
+
+    // 一次渲染任务：先写入带序号的临时文件，渲染完再改名为最终文件名，
+    // 这样并发的任务不会互相覆盖半写的 .dot / .png
+    struct Job {
+        string dotFile;
+        string imageFile;
+        string stagedDot;
+        string stagedImage;
+        uint64_t seq = 0;
+    };
+
+    // 为 dotFile/imageFile 分配一组唯一的临时文件名，调用方把 DOT 写入 stagedDot 后再 submit
+    auto stage(const string& dotFile, const string& imageFile) -> Job {
+        uint64_t seq = nextSeq.fetch_add(1) + 1;
+        string suffix = "." + to_string(seq) + ".tmp";
+        return {dotFile, imageFile, dotFile + suffix, imageFile + suffix, seq};
+    }
+
+    void submit(Job job) {
+        {
+            lock_guard<mutex> lock(mtx);
+            jobs.push_back(move(job));
+            pending++;
+            // 按需增加工作线程，不超过上限
+            if (workers.size() < maxWorkers && workers.size() < pending) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+        wakeup.notify_one();
+    }
+
+    void wait() {
+        unique_lock<mutex> lock(mtx);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    void work() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wakeup.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) { return;
+}
+            Job job = move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            string cmd = "dot -Tpng \"" + job.stagedDot + "\" -o \"" + job.stagedImage + "\"";
+            bool rendered = system(cmd.c_str()) == 0;
+            lock.lock();
+            // 同一目标可能有多个任务先后完成，只让最新提交的那个生效；
+            // dot 不可用时仍保留 .dot 文件，和以前一样
+            uint64_t& latest = installed[job.imageFile];
+            if (job.seq > latest) {
+                latest = job.seq;
+                rename(job.stagedDot.c_str(), job.dotFile.c_str());
+                if (rendered) {
+                    rename(job.stagedImage.c_str(), job.imageFile.c_str());
+                } else {
+                    remove(job.stagedImage.c_str());
+                }
+            } else {
+                remove(job.stagedDot.c_str());
+                remove(job.stagedImage.c_str());
+            }
+            if (--pending == 0) { done.notify_all();
+}
+        }
+    }
+
+    const unsigned maxWorkers;
+    mutex mtx;
+    condition_variable wakeup;
+    condition_variable done;
+    deque<Job> jobs;
+    vector<thread> workers;
+    unordered_map<string, uint64_t> installed;
+    atomic<uint64_t> nextSeq{0};
+    size_t pending = 0;
+    bool stopping = false;
+};
+
+// 程序内共用的渲染队列，进程退出前会等待所有图片渲染完
+auto dotRenderer() -> DotRenderer& {
+    static DotRenderer renderer(min(4u, max(thread::hardware_concurrency(), 1u)));
+    return renderer;
+}
+
+// 导出 DOT 文件，edgeColors 中的边（按 edgeKey 编码）用对应的颜色加粗标注
+void exportToDot(const Graph& graph, const string& filename,
+                 const unordered_map<uint64_t, string>& edgeColors) {
+    ofstream dotFile(filename);
+    dotFile << "digraph G {\n";
+    dotFile << "  rankdir=LR;\n";  // 设置从左到右的布局
+
+    const auto& csr = graph.getCsr();
+    for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+        const string src = graph.wordOf(u);
+        for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            dotFile << "  \"" << src << "\" -> \"" << graph.wordOf(csr.targets[e]) << "\" [";
+            // 如果边在要标注的路径上，则用该路径的颜色标注
+            auto color = edgeColors.find(edgeKey(u, csr.targets[e]));
+            if (color != edgeColors.end()) {
+                dotFile << "color=" << color->second << ", penwidth=2.0, ";
+            }
+            dotFile << "label=\"" << csr.weights[e] << "\"];\n";
+        }
+    }
+    dotFile << "}\n";
+    dotFile.close();
+}
+
+void exportToDot(const Graph& graph, const string& filename = "graph.dot", 
+                const vector<string>& highlightPath = vector<string>()) {
+    unordered_map<uint64_t, string> highlightEdges;
+    for (size_t i = 0; i + 1 < highlightPath.size(); ++i) {
+        highlightEdges.emplace(edgeKey(graph.findWord(highlightPath[i]), graph.findWord(highlightPath[i + 1])), "red");
+    }
+    exportToDot(graph, filename, highlightEdges);
+}
+
+// 把多条路径画在同一张图上，每条路径一种颜色；几条路径共用的边取排名靠前的那条的颜色
+void exportToDot(const Graph& graph, const string& filename, const vector<RankedPath>& paths) {
+    static const char* const palette[] = {"red", "blue", "darkgreen", "orange", "purple",
+                                          "brown", "magenta", "cyan4", "gold3", "gray40"};
+    unordered_map<uint64_t, string> edgeColors;
+    for (size_t p = paths.size(); p-- > 0;) {
+        const auto& vertices = paths[p].vertices;
+        for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+            edgeColors[edgeKey(vertices[i], vertices[i + 1])] = palette[p % size(palette)];
+        }
+    }
+    exportToDot(graph, filename, edgeColors);
+}
+
+// 更新showDirectedGraph函数，添加导出选项
+void showDirectedGraph(const Graph& graph, bool exportImage = false) {
+    // 原有命令行展示逻辑
+    const auto& csr = graph.getCsr();
+    cout << "Directed Graph:\n";
+    for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+        // 只作为目标出现、没有出边的单词不单独成行
+        if (csr.outDegree(u) == 0) { continue;
+}
+        cout << graph.wordOf(u) << " -> ";
+        for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            cout << graph.wordOf(csr.targets[e]) << "(" << csr.weights[e] << ") ";
+        }
+
+        cout << "\n";
+    }
+
+
+    // 导出为图像文件（可选功能）
+    if (exportImage) {
+        auto job = dotRenderer().stage("graph.dot", "graph.png");
+        exportToDot(graph, job.stagedDot);
+        dotRenderer().submit(move(job));
+        cout << "\nGraph image will be saved to graph.png\n";
+    }
+}
+
+auto queryBridgeWords(Graph& graph, const string& word1, const string& word2) -> string {
+    BridgeResult bridges = graph.getBridgeWords(word1, word2);
+    switch (bridges.status) {
+        case BridgeStatus::MissingBoth:
+            return "No \"" + word1 + "\" and \"" + word2 + "\" in the graph!";
+        case BridgeStatus::MissingWord1:
+            return "No \"" + word1 + "\" in the graph!";
+        case BridgeStatus::MissingWord2:
+            return "No \"" + word2 + "\" in the graph!";
+        case BridgeStatus::NoBridge:
+            return "No bridge words from \"" + word1 + "\" to \"" + word2 + "\"!";
+        case BridgeStatus::Found:
+            break;
+    }
+    
+    stringstream ss;
+    ss << "The bridge words from \"" << word1 << "\" to \"" << word2 << "\" are: ";
+    for (size_t i = 0; i < bridges.size(); ++i) {
+        string_view bridge = graph.wordView(bridges[i]);
+        if (i == bridges.size() - 1) {
+            ss << "and \"" << bridge << "\".";
+        } else if (i == bridges.size() - 2) {
+            ss << "\"" << bridge << "\" ";
+        } else {
+            ss << "\"" << bridge << "\", ";
+        }
+    }
+    return ss.str();
+}
+
+// 在相邻两个已知词之间随机插入一个桥接词。每个线程用一个实例，切分与拼接的缓冲区在输入之间复用；
+// bridgesOf(id1, id2) 返回两词之间的桥接词（BridgeResult），由调用方决定查哪个缓存
+class TextRewriter {
+public:
+    template <class BridgesOf>
+    auto rewrite(const Graph& graph, const string& input, SplitMix64& rng, BridgesOf&& bridgesOf) -> const string& {
+        // 与 stringstream >> word 相同：按空白切分并转为小写
+        lowered.assign(input);
+        transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        tokens.clear();
+        ids.clear();
+        for (size_t pos = 0; pos < lowered.size();) {
+            while (pos < lowered.size() && isspace(static_cast<unsigned char>(lowered[pos])) != 0) { ++pos;
+}
+            size_t start = pos;
+            while (pos < lowered.size() && isspace(static_cast<unsigned char>(lowered[pos])) == 0) { ++pos;
+}
+            if (pos > start) {
+                tokens.emplace_back(lowered.data() + start, pos - start);
+                ids.push_back(graph.findWord(tokens.back()));
+            }
+        }
+
+        text.clear();
+        for (size_t k = 0; k < tokens.size(); ++k) {
+            if (k > 0) { text += ' ';
+}
+            text += tokens[k];
+            if (k + 1 == tokens.size() || ids[k] == WordInterner::npos || ids[k + 1] == WordInterner::npos) { continue;
+}
+            BridgeResult bridges = bridgesOf(ids[k], ids[k + 1]);
+            if (bridges.found()) {
+                text += ' ';
+                text += graph.wordView(bridges[rng.below(bridges.size())]);
+            }
+        }
+        return text;
+    }
+
+private:
+    string lowered;
+    vector<string_view> tokens;
+    vector<uint32_t> ids;
+    string text;
+};
+
+// 批量生成新文本，outputs[i] 对应 inputs[i]。第 i 条输入的随机数只由 (seed, i) 决定，
+// 结果与线程数和调度顺序无关，同一个 seed 可以复现。各线程按块动态领取输入，
+// 桥接词缓存、分词与结果缓冲区都按线程各用一份
+auto generateNewTexts(const Graph& graph, const vector<string>& inputs, uint64_t seed,
+                      unsigned threads = max(thread::hardware_concurrency(), 1u)) -> vector<string> {
+    constexpr size_t kChunk = 64;
+    graph.freeze();
+    vector<string> outputs(inputs.size());
+    const size_t chunks = (inputs.size() + kChunk - 1) / kChunk;
+    atomic<size_t> nextChunk{0};
+
+    // 输入很少时不必启动多余的线程。图在批处理期间不变，每个线程用自己的桥接词缓存，无需加锁
+    runThreads(static_cast<unsigned>(min<size_t>(threads, chunks)), [&](unsigned) {
+        TextRewriter rewriter;
+        BridgeCache cache;
+        auto bridgesOf = [&](uint32_t word1, uint32_t word2) { return graph.getBridgeWords(word1, word2, cache); };
+        for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            size_t end = min(inputs.size(), (chunk + 1) * kChunk);
+            for (size_t i = chunk * kChunk; i < end; ++i) {
+                SplitMix64 rng(seed ^ SplitMix64(i).next());
+                outputs[i].assign(rewriter.rewrite(graph, inputs[i], rng, bridgesOf));
+            }
+        }
+    });
+    return outputs;
+}
+
+auto generateNewText(Graph& graph, const string& input) -> string {
+    random_device rd;
+    SplitMix64 rng((static_cast<uint64_t>(rd()) << 32) | rd());
+    // 交互查询走图自带的桥接词缓存，同一对词反复出现时不必重新求交
+    TextRewriter rewriter;
+    return rewriter.rewrite(graph, input, rng,
+                            [&](uint32_t word1, uint32_t word2) { return graph.getBridgeWords(word1, word2); });
+}
+
+auto calcShortestPath(Graph& graph, const string& word1, const string& word2, bool renderImage = true) -> string {
+    auto path = graph.shortestPath(word1, word2);
+    if (path.empty()) { return "No path from " + word1 + " to " + word2 + "!";
+}
+    
+    // 导出带有红色标注的路径图（只要文字结果时跳过渲染）
+    if (renderImage) {
+        auto job = dotRenderer().stage("graph.dot", "graph.png");
+        exportToDot(graph, job.stagedDot, path);
+        dotRenderer().submit(move(job));
+    }
+    
+    stringstream ss;
+    ss << "Shortest path: ";
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) { ss << " -> ";
+}
+        ss << path[i];
+    }
+    if (renderImage) {
+        ss << "\nGraph with highlighted path will be saved to graph.png";
+    }
+    return ss.str();
+}
+
+// 前 k 条无环最短路径，每条附上总权重；所有路径画在同一张图上，每条一种颜色
+auto calcKShortestPaths(Graph& graph, const string& word1, const string& word2, size_t k,
+                        bool renderImage = true) -> string {
+    auto paths = graph.kShortestPaths(word1, word2, k);
+    if (paths.empty()) { return "No path from " + word1 + " to " + word2 + "!";
+}
+
+    stringstream ss;
+    ss << "Top " << paths.size() << " shortest paths from " << word1 << " to " << word2 << ":";
+    for (size_t i = 0; i < paths.size(); ++i) {
+        ss << "\n" << i + 1 << ". (" << paths[i].length << ") ";
+        for (size_t j = 0; j < paths[i].vertices.size(); ++j) {
+            if (j > 0) { ss << " -> ";
+}
+            ss << graph.wordView(paths[i].vertices[j]);
+        }
+    }
+    if (renderImage) {
+        string dotFile = "paths_" + word1 + "_to_" + word2 + ".dot";
+        string imageFile = "paths_" + word1 + "_to_" + word2 + ".png";
+        auto job = dotRenderer().stage(dotFile, imageFile);
+        exportToDot(graph, job.stagedDot, paths);
+        dotRenderer().submit(move(job));
+        ss << "\nGraph with highlighted paths will be saved to " << imageFile;
+    }
+    return ss.str();
+}
+
+// 修改计算单源最短路径的函数：所有路径都画在同一张图上（即最短路径树），只渲染一次
+auto calcShortestPathToAll(Graph& graph, const string& source, bool renderImage = true) -> string {
+    if (graph.findWord(source) == WordInterner::npos) {
+        return "输入的单词 '" + source + "' 不在图中！";
+    }
+
+    // 一次单源搜索得到整棵最短路径树，每个目标的路径都从树上回溯得到
+    auto tree = graph.shortestPathTree(source);
+    string imageFile = "path_" + source + "_to_all.png";
+
+    stringstream result;
+    result << "从单词 '" << source << "' 到其他所有单词的最短路径：\n";
+    if (renderImage) {
+        unordered_map<uint64_t, string> treeEdges;
+        for (uint32_t id = 0; id < graph.vertexCount(); ++id) {
+            if (id != tree.source && tree.reachable(id)) {
+                treeEdges.emplace(edgeKey(tree.prev[id], id), "red");
+            }
+        }
+        string dotFile = "path_" + source + "_to_all.dot";
+        auto job = dotRenderer().stage(dotFile, imageFile);
+        exportToDot(graph, job.stagedDot, treeEdges);
+        dotRenderer().submit(move(job));
+        result << "(所有路径已标注在 " << imageFile << " 中)\n";
+    }
+
+    vector<pair<string, uint32_t>> destinations;
+    for (uint32_t id = 0; id < graph.vertexCount(); ++id) {
+        string dest = graph.wordOf(id);
+        if (dest != source) {
+            destinations.emplace_back(move(dest), id);
+        }
+    }
+    sort(destinations.begin(), destinations.end());
+
+    for (const auto& [dest, destId] : destinations) {
+        auto path = tree.pathTo(destId);
+        result << "\n到 '" << dest << "' 的最短路径: ";
+        if (path.empty()) {
+            result << "不存在路径";
+        } else {
+            for (size_t i = 0; i < path.size(); ++i) {
+                if (i > 0) { result << " -> ";
+}
+                result << graph.wordOf(path[i]);
+            }
+        }
+    }
+    
+    return result.str();
+}
+
+// 多源最短路径引擎：对 sources 中的每个源点跑一次单源 Dijkstra。线程逐个动态领取源点，
+// 每个线程的最短路径树与优先队列在源点之间复用；每棵树算完立即交给 visit(sourceIndex, tree)，
+// 调用方当场写出结果，内存里不需要保留 V×V 的距离表。visit 会被多个线程同时调用
+template <class Queue = PathQueue, class Visitor>
+void forEachShortestPathTree(const CsrGraph& g, const vector<uint32_t>& sources, unsigned threads, Visitor&& visit) {
+    atomic<size_t> nextSource{0};
+    runThreads(static_cast<unsigned>(min<size_t>(threads, sources.size())), [&](unsigned) {
+        ShortestPathTree tree;
+        Queue queue;
+        for (size_t i = nextSource++; i < sources.size(); i = nextSource++) {
+            runDijkstra(g, sources[i], tree, false, queue);
+            visit(i, tree);
+        }
+    });
+}
+
+// 距离矩阵文件：头部（魔数、版本、行数、列数）之后是各行的源点编号，再后面每行是源点到
+// 全部节点的 int32 距离（不可达为 -1）。行的位置固定，各线程用 pwrite 直接写到自己的行
+class DistanceMatrixFile {
+public:
+    DistanceMatrixFile(const string& path, const vector<uint32_t>& sources, size_t columns)
+        : rows(sources.size()), columns(columns) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) { return;
+}
+        string header(kHeaderBytes, '\0');
+        const uint64_t rowCount = rows;
+        const uint64_t columnCount = columns;
+        memcpy(&header[0], kMagic, sizeof(kMagic));
+        memcpy(&header[8], &kVersion, sizeof(kVersion));
+        memcpy(&header[16], &rowCount, sizeof(rowCount));
+        memcpy(&header[24], &columnCount, sizeof(columnCount));
+        ok = writeAt(header.data(), header.size(), 0) &&
+             writeAt(sources.data(), sources.size() * sizeof(uint32_t), kHeaderBytes);
+    }
+
+    ~DistanceMatrixFile() {
+        if (fd >= 0) { ::close(fd);
+}
+    }
+
+    DistanceMatrixFile(const DistanceMatrixFile&) = delete;
+    auto operator=(const DistanceMatrixFile&) -> DistanceMatrixFile& = delete;
+
+    auto isOpen() const -> bool { return fd >= 0 && ok; }
+
+    // 可以被多个线程同时调用，写入的是互不重叠的区间。values 是调用方（每个线程一个）复用的转换缓冲区
+    void writeRow(size_t row, const vector<int>& dist, vector<int32_t>& values) {
+        values.resize(dist.size());
+        for (size_t v = 0; v < dist.size(); ++v) {
+            values[v] = dist[v] == INT_MAX ? -1 : dist[v];
+        }
+        auto offset = static_cast<off_t>(kHeaderBytes + rows * sizeof(uint32_t) + row * columns * sizeof(int32_t));
+        if (!writeAt(values.data(), values.size() * sizeof(int32_t), offset)) { ok = false;
+}
+    }
+
+private:
+    static constexpr char kMagic[8] = {'W', 'G', 'D', 'I', 'S', 'T', 'M', 'X'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderBytes = 32;
+
+    auto writeAt(const void* data, size_t size, off_t offset) const -> bool {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::pwrite(fd, bytes, size, offset);
+            if (written <= 0) { return false;
+}
+            bytes += written;
+            size -= static_cast<size_t>(written);
+            offset += written;
+        }
+        return true;
+    }
+
+    int fd = -1;
+    size_t rows;
+    size_t columns;
+    atomic<bool> ok{false};
+};
+
+// 把 sources 到全部节点的距离写成二进制矩阵
+auto writeDistanceMatrix(const Graph& graph, const vector<uint32_t>& sources, const string& path,
+                         unsigned threads = max(thread::hardware_concurrency(), 1u)) -> bool {
+    const auto& g = graph.getCsr();
+    DistanceMatrixFile file(path, sources, g.vertexCount());
+    if (!file.isOpen()) { return false;
+}
+    forEachShortestPathTree(g, sources, threads, [&file](size_t row, const ShortestPathTree& tree) {
+        thread_local vector<int32_t> values;
+        file.writeRow(row, tree.dist, values);
+    });
+    return file.isOpen();
+}
+
+// 每个源点输出一行：源点单词，然后是距离最近的 k 个可达单词（按距离、编号升序），形如 word:dist
+void writeNearestLists(const Graph& graph, const vector<uint32_t>& sources, size_t k, ostream& out,
+                       unsigned threads = max(thread::hardware_concurrency(), 1u)) {
+    const auto& g = graph.getCsr();
+    OrderedWriter writer(out);
+    forEachShortestPathTree(g, sources, threads, [&](size_t row, const ShortestPathTree& tree) {
+        thread_local vector<pair<int, uint32_t>> reached;
+        reached.clear();
+        for (uint32_t v = 0; v < tree.dist.size(); ++v) {
+            if (v != tree.source && tree.reachable(v)) { reached.emplace_back(tree.dist[v], v);
+}
+        }
+        size_t count = min(k, reached.size());
+        partial_sort(reached.begin(), reached.begin() + static_cast<ptrdiff_t>(count), reached.end());
+        string line(graph.wordView(tree.source));
+        for (size_t i = 0; i < count; ++i) {
+            line += ' ';
+            line += graph.wordView(reached[i].second);
+            line += ':';
+            line += to_string(reached[i].first);
+        }
+        line += '\n';
+        writer.submit(row, move(line));
+    });
+}
+
+// 随机游走语料的参数：从每个有出边的节点出发各走 walksPerNode 次，每条游走最多 maxLength 个节点（至少为 1）。
+// p、q 是 node2vec 的返回与进出参数（见 Graph::biasedWalk），都为 1 时就是普通的一阶游走。
+// binary 为 false 时每行一条游走、单词以空格分隔；为 true 时写成 writeWalkCorpus 说明的二进制格式
+struct WalkCorpusOptions {
+    size_t walksPerNode = 10;
+    size_t maxLength = 80;
+    bool weighted = false;
+    bool binary = false;
+    uint64_t seed = 0;
+    double p = 1.0;
+    double q = 1.0;
+};
+
+// 批量生成随机游走语料，返回游走条数。与 Graph::randomWalk 一样只从有出边的节点出发（没有出边的节点
+// 只能得到单个词），第 r 轮从第 i 个起点出发的游走编号为 r * 起点数 + i，它的随机数只由
+// (seed, 编号) 决定，输出又按编号排列，所以同一个 seed 在任意线程数下得到逐字节相同的文件。
+// 线程按块领取游走，每块先写进线程自己的缓冲区，再由 OrderedWriter 按块号顺序写出。
+// 二进制格式：32 字节头部（魔数、版本、节点数、游走条数），然后是词表（每个单词以 '\n' 结尾，
+// 第 i 行即编号 i），再后面每条游走是一个 uint32 节点数加上同样个数的 uint32 节点编号
+auto writeWalkCorpus(const Graph& graph, const WalkCorpusOptions& options, ostream& out,
+                     unsigned threads = max(thread::hardware_concurrency(), 1u)) -> size_t {
+    constexpr size_t kChunk = 1024;
+    constexpr char kMagic[8] = {'W', 'G', 'W', 'A', 'L', 'K', 'S', 'Q'};
+    constexpr uint32_t kVersion = 1;
+    // 别名表与 CSR 都在启动线程之前建好，之后各线程只读
+    const auto& g = graph.getCsr();
+    if (options.weighted) { graph.getWalkTables();
+}
+    const size_t vertices = g.vertexCount();
+    vector<uint32_t> starts;
+    for (uint32_t v = 0; v < vertices; ++v) {
+        if (g.outDegree(v) > 0) { starts.push_back(v);
+}
+    }
+    const size_t total = starts.size() * options.walksPerNode;
+    const size_t maxLength = max<size_t>(options.maxLength, 1);
+
+    if (options.binary) {
+        string header(32, '\0');
+        const uint64_t vertexCount = vertices;
+        const uint64_t walkCount = total;
+        memcpy(&header[0], kMagic, sizeof(kMagic));
+        memcpy(&header[8], &kVersion, sizeof(kVersion));
+        memcpy(&header[16], &vertexCount, sizeof(vertexCount));
+        memcpy(&header[24], &walkCount, sizeof(walkCount));
+        out << header;
+        for (uint32_t v = 0; v < vertices; ++v) {
+            out << graph.wordView(v) << '\n';
+        }
+    }
+
+    OrderedWriter writer(out);
+    const size_t chunks = (total + kChunk - 1) / kChunk;
+    atomic<size_t> nextChunk{0};
+    runThreads(static_cast<unsigned>(min<size_t>(threads, chunks)), [&](unsigned) {
+        WalkScratch scratch;
+        for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            string buffer;
+            size_t end = min(total, (chunk + 1) * kChunk);
+            for (size_t w = chunk * kChunk; w < end; ++w) {
+                SplitMix64 rng(options.seed ^ SplitMix64(w).next());
+                graph.biasedWalk(starts[w % starts.size()], options.p, options.q, options.weighted, rng, scratch,
+                                 maxLength);
+                if (options.binary) {
+                    auto length = static_cast<uint32_t>(scratch.path.size());
+                    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                    buffer.append(reinterpret_cast<const char*>(scratch.path.data()), length * sizeof(uint32_t));
+                    continue;
+                }
+                for (size_t i = 0; i < scratch.path.size(); ++i) {
+                    if (i > 0) { buffer += ' ';
+}
+                    buffer += graph.wordView(scratch.path[i]);
+                }
+                buffer += '\n';
+            }
+            writer.submit(chunk, move(buffer));
+        }
+    });
+    return total;
+}
+
+auto calcPageRank(Graph& graph, const string& word) -> double {
+    return graph.getPageRank(word);
+}
+
+// 菜单上显示的 PageRank 状态
+auto pageRankStatusText(PageRankStatus status, bool refreshOnQuery) -> const char* {
+    switch (status) {
+        case PageRankStatus::NotComputed:
+            return "not computed";
+        case PageRankStatus::Computing:
+            return "computing in background";
+        case PageRankStatus::Ready:
+            return "ready";
+        case PageRankStatus::Stale:
+            return refreshOnQuery ? "stale, recomputed on next query" : "stale";
+    }
+    return "";
+}
+
+auto randomWalk(Graph& graph, bool weighted = false) -> string {
+    return graph.randomWalk(weighted);
+}
+
+// 分词基准：把输入文件重复拼接到指定大小，分别用原先的 isalpha/tolower + stringstream 流程、
+// 逐字符扫描和向量化内核分词，比较吞吐量并校验三者产出的单词序列完全一致
+auto benchTokenize(const string& filename, size_t targetMB) -> int {
+    MappedFile file(filename);
+    if (!file.isOpen() || file.size() == 0) {
+        cerr << "Cannot open file: " << filename << "\n";
+        return 1;
+    }
+    string corpus;
+    corpus.reserve(targetMB << 20);
+    while (corpus.size() < (targetMB << 20)) {
+        corpus.append(file.data(), file.size());
+        corpus += '\n';
+    }
+
+    // 单词序列的 FNV-1a 指纹，单词之间插入分隔符
+    struct Digest {
+        uint64_t hash = 1469598103934665603ULL;
+        size_t count = 0;
+        void add(string_view word) {
+            for (char c : word) { hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+}
+            hash = (hash ^ ' ') * 1099511628211ULL;
+            count++;
+        }
+    };
+
+    auto run = [&](const char* name, auto&& tokenize) {
+        Digest digest;
+        auto start = chrono::steady_clock::now();
+        tokenize(digest);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cout << left << setw(10) << name << right << fixed << setprecision(3)
+             << setw(9) << elapsed.count() << " s  "
+             << setw(8) << corpus.size() / elapsed.count() / (1 << 30) << " GiB/s  "
+             << digest.count << " words  " << hex << digest.hash << dec << "\n";
+        return digest.hash;
+    };
+
+    cout << "Corpus: " << corpus.size() / (1 << 20) << " MiB\n";
+    uint64_t legacy = run("legacy", [&](Digest& digest) {
+        string processed;
+        processed.reserve(corpus.size());
+        for (char c : corpus) {
+            if (isalpha(c) != 0) { processed += static_cast<char>(tolower(c));
+            } else { processed += ' ';
+}
+        }
+        stringstream ss(processed);
+        string word;
+        while (ss >> word) { digest.add(word);
+}
+    });
+    uint64_t scalar = run("scalar", [&](Digest& digest) {
+        TextProcessor::forEachWordScalar(corpus.data(), corpus.size(), [&](string_view w) { digest.add(w); });
+    });
+    uint64_t simd = run("simd", [&](Digest& digest) {
+        TextProcessor::forEachWord(corpus.data(), corpus.size(), [&](string_view w) { digest.add(w); });
+    });
+    if (legacy != scalar || scalar != simd) {
+        cerr << "Tokenizer outputs differ!\n";
+        return 1;
+    }
+    return 0;
+}
+
+// PageRank 扩展性基准：固定迭代轮数，线程数按 1, 2, 4, ... 翻倍到 maxThreads，
+// 报告每秒处理的边数（边数 × 轮数 / 耗时）以及与单线程结果的最大偏差
+auto benchPageRank(const string& filename, unsigned maxThreads, int iterations) -> int {
+    Graph graph;
+    if (!TextProcessor::buildGraph(filename, graph)) {
+        cerr << "Cannot open file: " << filename << "\n";
+        return 1;
+    }
+    const auto& csr = graph.getCsr();
+    cout << "Graph: " << csr.vertexCount() << " vertices, " << csr.edgeCount() << " edges, "
+         << iterations << " iterations\n";
+
+    PageRankOptions options;
+    options.maxIterations = iterations;
+    vector<double> reference;
+    for (unsigned threads = 1;; threads = min(threads * 2, maxThreads)) {
+        options.threads = threads;
+        auto start = chrono::steady_clock::now();
+        graph.calculatePageRank(options);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        double maxDiff = 0.0;
+        for (uint32_t id = 0; id < csr.vertexCount(); ++id) {
+            double rank = graph.getPageRank(graph.wordOf(id));
+            if (threads == 1) { reference.push_back(rank);
+            } else { maxDiff = max(maxDiff, fabs(rank - reference[id]));
+}
+        }
+        cout << setw(4) << threads << " threads  " << fixed << setprecision(3) << setw(9) << elapsed.count() << " s  "
+             << setprecision(1) << setw(9) << static_cast<double>(csr.edgeCount()) * iterations / elapsed.count() / 1e6
+             << " M edges/s  max diff " << scientific << setprecision(2) << maxDiff << defaultfloat << "\n";
+        if (threads >= maxThreads) { break;
+}
+    }
+    return 0;
+}
+
+// 对同一组随机查询分别用三种优先队列跑点对点双向搜索与单源最短路径树，比较耗时并核对路径长度
+template <class Queue>
+void benchPathQueue(const char* name, const CsrGraph& g, const vector<pair<uint32_t, uint32_t>>& queries,
+                    vector<int64_t>& lengths) {
+    BidirectionalDijkstra<Queue> search;
+    size_t settled = 0;
+    size_t mismatches = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        search.search(g, queries[i].first, queries[i].second);
+        settled += search.stats().settled;
+        if (lengths.size() <= i) { lengths.push_back(search.stats().length);
+        } else if (lengths[i] != search.stats().length) { mismatches++;
+}
+    }
+    chrono::duration<double> pointToPoint = chrono::steady_clock::now() - start;
+
+    // 单源最短路径树的代价高得多，只取前几个查询的源点
+    const size_t trees = min<size_t>(queries.size(), 8);
+    ShortestPathTree tree;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < trees; ++i) {
+        runDijkstra<Queue>(g, queries[i].first, tree);
+    }
+    chrono::duration<double> fullTree = chrono::steady_clock::now() - start;
+
+    cout << left << setw(12) << name << right << fixed << setprecision(2) << setw(10)
+         << pointToPoint.count() * 1e6 / max<size_t>(queries.size(), 1) << " us/query  " << setw(10)
+         << settled / max<size_t>(queries.size(), 1) << " settled/query  " << setw(10)
+         << fullTree.count() * 1e3 / max<size_t>(trees, 1) << " ms/tree  " << mismatches << " mismatches\n"
+         << defaultfloat;
+}
+
+auto benchShortestPath(const string& filename, size_t queryCount, unsigned landmarkCount) -> int {
+    Graph graph;
+    if (!TextProcessor::buildGraph(filename, graph)) {
+        cerr << "Cannot open file: " << filename << "\n";
+        return 1;
+    }
+    const auto& csr = graph.getCsr();
+    if (csr.vertexCount() == 0) {
+        cerr << "Empty graph: " << filename << "\n";
+        return 1;
+    }
+    cout << "Graph: " << csr.vertexCount() << " vertices, " << csr.edgeCount() << " edges, max weight "
+         << csr.maxWeight << ", " << queryCount << " queries\n";
+    if (queryCount == 0) { return 0;
+}
+
+    mt19937 gen(12345);
+    uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(csr.vertexCount() - 1));
+    vector<pair<uint32_t, uint32_t>> queries(queryCount);
+    for (auto& query : queries) {
+        query = {pick(gen), pick(gen)};
+    }
+    vector<int64_t> lengths;
+    benchPathQueue<BinaryHeapQueue>("binary-heap", csr, queries, lengths);
+    benchPathQueue<DialQueue>("dial", csr, queries, lengths);
+    benchPathQueue<RadixHeapQueue>("radix-heap", csr, queries, lengths);
+
+    // ALT：预处理一次地标表，之后的查询用双向 A*
+    auto start = chrono::steady_clock::now();
+    LandmarkIndex index;
+    index.build(csr, landmarkCount);
+    chrono::duration<double> preprocess = chrono::steady_clock::now() - start;
+    LandmarkAStar<> search;
+    size_t settled = 0;
+    size_t mismatches = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        search.search(csr, index, queries[i].first, queries[i].second);
+        settled += search.stats().settled;
+        mismatches += search.stats().length != lengths[i];
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << left << setw(12) << ("alt K=" + to_string(index.size())) << right << fixed << setprecision(2) << setw(10)
+         << elapsed.count() * 1e6 / queries.size() << " us/query  " << setw(10) << settled / queries.size()
+         << " settled/query  " << setw(10) << preprocess.count() * 1e3 << " ms preprocess  " << mismatches
+         << " mismatches\n" << defaultfloat;
+    return 0;
+}
+
+// 批量改写：inputs 文件每行一条文本，结果按行写入 outputs，顺序与输入一致
+auto generateBatch(const string& corpus, const string& inputsFile, const string& outputsFile, unsigned threads,
+                   uint64_t seed) -> int {
+    Graph graph;
+    if (!TextProcessor::buildGraph(corpus, graph)) {
+        cerr << "Cannot open file: " << corpus << "\n";
+        return 1;
+    }
+    ifstream in(inputsFile);
+    if (!in) {
+        cerr << "Cannot open file: " << inputsFile << "\n";
+        return 1;
+    }
+    vector<string> inputs;
+    for (string line; getline(in, line);) {
+        inputs.push_back(move(line));
+    }
+
+    auto start = chrono::steady_clock::now();
+    auto outputs = generateNewTexts(graph, inputs, seed, threads);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    ofstream out(outputsFile);
+    for (const auto& text : outputs) {
+        out << text << '\n';
+    }
+    if (!out) {
+        cerr << "Cannot write file: " << outputsFile << "\n";
+        return 1;
+    }
+    cerr << "Generated " << outputs.size() << " texts on " << threads << " threads in " << fixed << setprecision(3)
+         << elapsed.count() << " s\n";
+    return 0;
+}
+
+// 读取源点列表：spec 为 "all" 时取整个词表，否则是每行一个单词的文件，不在图中的单词跳过
+auto readSources(const Graph& graph, const string& spec, vector<uint32_t>& sources) -> bool {
+    if (spec == "all") {
+        sources.resize(graph.vertexCount());
+        iota(sources.begin(), sources.end(), 0u);
+        return true;
+    }
+    ifstream in(spec);
+    if (!in) { return false;
+}
+    size_t skipped = 0;
+    for (string word; in >> word;) {
+        transform(word.begin(), word.end(), word.begin(), ::tolower);
+        uint32_t id = graph.findWord(word);
+        if (id == WordInterner::npos) { skipped++;
+        } else { sources.push_back(id);
+}
+    }
+    if (skipped > 0) { cerr << "Skipped " << skipped << " words that are not in the graph\n";
+}
+    return true;
+}
+
+// 多源最短路径：k 为 0 时把距离矩阵写成二进制文件，否则按行写出每个源点最近的 k 个单词
+auto multiSourcePaths(const string& corpus, const string& sourceSpec, size_t k, const string& outputFile,
+                      unsigned threads) -> int {
+    Graph graph;
+    if (!TextProcessor::buildGraph(corpus, graph)) {
+        cerr << "Cannot open file: " << corpus << "\n";
+        return 1;
+    }
+    vector<uint32_t> sources;
+    if (!readSources(graph, sourceSpec, sources)) {
+        cerr << "Cannot open file: " << sourceSpec << "\n";
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    bool written = true;
+    if (k == 0) {
+        written = writeDistanceMatrix(graph, sources, outputFile, threads);
+    } else {
+        ofstream out(outputFile);
+        writeNearestLists(graph, sources, k, out, threads);
+        written = static_cast<bool>(out);
+    }
+    if (!written) {
+        cerr << "Cannot write file: " << outputFile << "\n";
+        return 1;
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cerr << "Searched from " << sources.size() << " sources over " << graph.vertexCount() << " vertices on "
+         << threads << " threads in " << fixed << setprecision(3) << elapsed.count() << " s\n";
+    return 0;
+}
+
+// 随机游走语料：结果写入 outputFile，统计信息输出到 stderr
+auto walkCorpus(const string& corpus, const string& outputFile, const WalkCorpusOptions& options, unsigned threads)
+    -> int {
+    Graph graph;
+    if (!TextProcessor::buildGraph(corpus, graph)) {
+        cerr << "Cannot open file: " << corpus << "\n";
+        return 1;
+    }
+    ofstream out(outputFile, ios::binary);
+    if (!out) {
+        cerr << "Cannot write file: " << outputFile << "\n";
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    size_t walks = writeWalkCorpus(graph, options, out, threads);
+    out.flush();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (!out) {
+        cerr << "Cannot write file: " << outputFile << "\n";
+        return 1;
+    }
+    cerr << "Wrote " << walks << " walks over " << graph.vertexCount() << " vertices on " << threads << " threads in "
+         << fixed << setprecision(3) << elapsed.count() << " s (" << setprecision(0)
+         << walks / max(elapsed.count(), 1e-9) << " walks/s)\n";
+    return 0;
+}
+
+// 建图并计算 PageRank（参数与交互模式相同），写成快照；之后把快照文件当作语料传入即可跳过分词与建图
+auto saveSnapshot(const string& corpus, const string& snapshotFile) -> int {
+    Graph graph;
+    auto start = chrono::steady_clock::now();
+    if (!TextProcessor::buildGraph(corpus, graph)) {
+        cerr << "Cannot open file: " << corpus << "\n";
+        return 1;
+    }
+    if (!graph.hasPageRank()) {
+        PageRankOptions rankOptions;
+        rankOptions.tolerance = 1e-10;
+        rankOptions.threads = max(thread::hardware_concurrency(), 1u);
+        graph.calculatePageRank(rankOptions);
+    }
+    chrono::duration<double> built = chrono::steady_clock::now() - start;
+    if (!graph.saveSnapshot(snapshotFile)) {
+        cerr << "Cannot write file: " << snapshotFile << "\n";
+        return 1;
+    }
+    start = chrono::steady_clock::now();
+    Graph loaded;
+    if (!loaded.loadSnapshot(snapshotFile)) {
+        cerr << "Cannot load snapshot: " << snapshotFile << "\n";
+        return 1;
+    }
+    chrono::duration<double> mapped = chrono::steady_clock::now() - start;
+    cerr << "Saved " << graph.vertexCount() << " vertices and " << graph.getCsr().edgeCount() << " edges; build "
+         << fixed << setprecision(3) << built.count() << " s, snapshot load " << mapped.count() * 1e3 << " ms\n";
+    return 0;
+}
+
+// --self-test 的结果汇总：每项打印一行 PASS/FAIL，最后按失败项数决定退出码
+class SelfTestReport {
+public:
+    void check(const string& name, bool ok, const string& detail = "") {
+        cout << (ok ? "PASS  " : "FAIL  ") << name;
+        if (!detail.empty()) { cout << "  (" << detail << ")";
+}
+        cout << "\n";
+        if (!ok) { failed++;
+}
+    }
+
+    auto failures() const -> size_t {
+        return failed;
+    }
+
+private:
+    size_t failed = 0;
+};
+
+// 自检用的图：给了语料文件就用它，否则用固定种子生成一段词频偏斜的合成语料，结果可重复
+auto buildSelfTestGraph(const string& filename, Graph& graph) -> bool {
+    if (!filename.empty()) { return TextProcessor::buildGraph(filename, graph);
+}
+    SplitMix64 rng(0x5e1f7e57);
+    string previous;
+    for (int i = 0; i < 100000; ++i) {
+        string word = "w" + to_string(rng.below(rng.below(20000) + 1));
+        if (!previous.empty()) { graph.addEdge(previous, word);
+}
+        previous = move(word);
+    }
+    // 一对与主体不连通的词：前者没有入边，后者没有出边，供最短路径检查覆盖不可达的情况
+    graph.addEdge("island-source", "island-sink");
+    return true;
+}
+
+// 并行建图：同一份语料分别用 1 个线程和多个线程分块构建，词表（含编号）与 CSR 应完全相同。
+// 每块至少 1 MiB，所以语料要有几 MiB 才会真正分块；其中混入大小写、各种分隔符，
+// 以及一个长达 1.5 MiB、必然跨过块边界的单词
+void selfTestParallelBuild(SelfTestReport& report) {
+    const string path = "selftest_corpus.txt";
+    {
+        const char* separators[] = {" ", " ", " ", ", ", ".\n", " -- ", "\t", "'", " 42 "};
+        SplitMix64 rng(0xb0b1d);
+        string text;
+        bool longWord = false;
+        while (text.size() < (4u << 20)) {
+            if (!longWord && text.size() >= (3u << 19)) {
+                text.append(3u << 19, 'q');
+                longWord = true;
+            }
+            // 词频偏斜的单词，以 26 进制写成字母，约四分之一的字母大写
+            uint64_t n = rng.below(rng.below(800) + 1);
+            while (true) {
+                auto letter = static_cast<char>('a' + n % 26);
+                text += rng.below(4) == 0 ? static_cast<char>(letter - 'a' + 'A') : letter;
+                n /= 26;
+                if (n == 0) { break;
+}
+            }
+            text += separators[rng.below(size(separators))];
+        }
+        ofstream(path, ios::binary) << text;
+    }
+
+    auto sameArray = [](const auto& x, const auto& y) {
+        return x.size() == y.size() && equal(x.begin(), x.end(), y.begin());
+    };
+    Graph serial;
+    bool built = TextProcessor::buildGraph(path, serial, 1);
+    const auto& a = serial.getCsr();
+    size_t mismatches = 0;
+    for (unsigned threads : {2u, 3u, 4u}) {
+        Graph parallel;
+        built = TextProcessor::buildGraph(path, parallel, threads) && built;
+        const auto& b = parallel.getCsr();
+        bool same = parallel.vertexCount() == serial.vertexCount() && b.maxWeight == a.maxWeight &&
+                    sameArray(b.offsets, a.offsets) && sameArray(b.targets, a.targets) &&
+                    sameArray(b.weights, a.weights) && sameArray(b.inOffsets, a.inOffsets) &&
+                    sameArray(b.inSources, a.inSources) && sameArray(b.inWeights, a.inWeights);
+        for (uint32_t id = 0; same && id < serial.vertexCount(); ++id) {
+            same = parallel.wordView(id) == serial.wordView(id);
+        }
+        mismatches += same ? 0 : 1;
+    }
+    remove(path.c_str());
+    report.check("parallel graph build matches the serial build", built && mismatches == 0,
+                 to_string(serial.vertexCount()) + " words, " + to_string(a.edgeCount()) +
+                     " edges; 2/3/4 threads, " + to_string(mismatches) + " mismatches");
+}
+
+// PageRank：默认参数（Jacobi 跑满 100 轮）与按定义逐条出边累加 PR(u) / 出度(u) 的朴素幂迭代
+// 相差不超过 1e-12；多线程时悬挂总和按线程分段求和，结果与单线程也只差舍入误差
+void selfTestPageRank(const string& filename, SelfTestReport& report) {
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    const auto& g = graph.getCsr();
+    const size_t V = g.vertexCount();
+    const double d = 0.85;
+    vector<double> reference(V, 1.0 / V);
+    vector<double> sumIn(V);
+    for (int i = 0; i < 100; ++i) {
+        double dangling = 0.0;
+        fill(sumIn.begin(), sumIn.end(), 0.0);
+        for (uint32_t u = 0; u < V; ++u) {
+            if (g.outDegree(u) == 0) { dangling += reference[u];
+}
+            for (uint64_t e = g.offsets[u]; e < g.offsets[u + 1]; ++e) {
+                sumIn[g.targets[e]] += reference[u] / g.outDegree(u);
+            }
+        }
+        for (uint32_t v = 0; v < V; ++v) { reference[v] = (1.0 - d) / V + d * (sumIn[v] + dangling / V);
+}
+    }
+
+    graph.calculatePageRank();
+    vector<double> serial(V);
+    double difference = 0.0;
+    for (uint32_t id = 0; id < V; ++id) {
+        serial[id] = graph.getPageRank(graph.wordOf(id));
+        difference = max(difference, fabs(serial[id] - reference[id]));
+    }
+    stringstream detail;
+    detail << "max difference " << scientific << setprecision(2) << difference;
+    report.check("PageRank matches the plain power iteration", difference <= 1e-12, detail.str());
+
+    double threadDifference = 0.0;
+    for (unsigned threads : {2u, 3u, 7u}) {
+        PageRankOptions options;
+        options.threads = threads;
+        graph.calculatePageRank(options);
+        for (uint32_t id = 0; id < V; ++id) {
+            threadDifference = max(threadDifference, fabs(graph.getPageRank(graph.wordOf(id)) - serial[id]));
+        }
+    }
+    stringstream threadDetail;
+    threadDetail << "2/3/7 threads, max difference " << scientific << setprecision(2) << threadDifference;
+    report.check("multi-threaded PageRank matches the single-threaded run", threadDifference <= 1e-12,
+                 threadDetail.str());
+}
+
+// 增量 PageRank：加入几条新边（含一个新节点）后做残差推送，结果与精确解的 L1 距离应不超过
+// 2 × tolerance / (1 - d)——残差为 r 时误差不超过 |r| / (1 - d)，而推送前的结果本身还带着
+// 不超过 tolerance 的残差；同时要求确实走的是推送路径
+void selfTestIncrementalPageRank(const string& filename, SelfTestReport& report) {
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    PageRankOptions options;
+    options.tolerance = 1e-6;  // 推送只在容差不太严时才比热启动的完整迭代便宜
+    options.maxIterations = 1000;
+    graph.setIncrementalPageRank(true);
+    graph.calculatePageRank(options);
+
+    SplitMix64 rng(42);
+    const auto vertices = static_cast<uint32_t>(graph.vertexCount());
+    for (int i = 0; i < 5; ++i) {
+        graph.addEdge(static_cast<uint32_t>(rng.below(vertices)), static_cast<uint32_t>(rng.below(vertices)));
+    }
+    uint32_t fresh = graph.addWord("selftest-new-word");
+    graph.addEdge(static_cast<uint32_t>(rng.below(vertices)), fresh);
+    graph.addEdge(fresh, static_cast<uint32_t>(rng.below(vertices)));
+    bool incremental = graph.updatePageRank();
+    vector<double> updated(graph.vertexCount());
+    for (uint32_t id = 0; id < updated.size(); ++id) { updated[id] = graph.getPageRank(graph.wordOf(id));
+}
+
+    PageRankOptions exact = options;
+    exact.tolerance = 1e-14;
+    graph.calculatePageRank(exact);
+    double distance = 0.0;
+    for (uint32_t id = 0; id < updated.size(); ++id) {
+        distance += fabs(graph.getPageRank(graph.wordOf(id)) - updated[id]);
+    }
+    stringstream detail;
+    detail << (incremental ? "push refresh" : "fell back to full recompute") << ", L1 error " << scientific
+           << setprecision(2) << distance;
+    report.check("incremental PageRank matches full recompute",
+                 incremental && distance <= 2.0 * options.tolerance / (1.0 - options.damping), detail.str());
+}
+
+// 桥接词：intersectSorted 在各种长度比（含倍增查找的分支）下与 set_intersection 一致；
+// 图上的 getBridgeWords（含缓存命中与加边后的失效）与逐个检查 a -> w -> b 的朴素做法一致
+void selfTestBridgeWords(const string& filename, SelfTestReport& report) {
+    SplitMix64 rng(7);
+    size_t kernelMismatches = 0;
+    for (size_t shortLength : {0, 1, 5, 40}) {
+        for (size_t ratio : {1, 3, 16, 100, 1000}) {
+            vector<uint32_t> a(shortLength);
+            vector<uint32_t> b(shortLength * ratio + 1);
+            const auto range = static_cast<uint32_t>(2 * b.size() + 1);
+            for (auto& value : a) { value = static_cast<uint32_t>(rng.below(range));
+}
+            for (auto& value : b) { value = static_cast<uint32_t>(rng.below(range));
+}
+            for (auto* list : {&a, &b}) {
+                sort(list->begin(), list->end());
+                list->erase(unique(list->begin(), list->end()), list->end());
+            }
+            vector<uint32_t> expected;
+            set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected));
+            vector<uint32_t> forward;
+            vector<uint32_t> backward;
+            intersectSorted(a.data(), a.size(), b.data(), b.size(), forward);
+            intersectSorted(b.data(), b.size(), a.data(), a.size(), backward);
+            if (forward != expected || backward != expected) { kernelMismatches++;
+}
+        }
+    }
+    report.check("sorted-list intersection matches set_intersection", kernelMismatches == 0,
+                 to_string(kernelMismatches) + " mismatches");
+
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    const auto& g = graph.getCsr();
+    const auto vertices = static_cast<uint32_t>(g.vertexCount());
+    auto bruteForce = [&](uint32_t a, uint32_t b) {
+        vector<uint32_t> mids;
+        for (uint64_t e = g.offsets[a]; e < g.offsets[a + 1]; ++e) {
+            uint32_t w = g.targets[e];
+            for (uint64_t f = g.offsets[w]; f < g.offsets[w + 1]; ++f) {
+                if (g.targets[f] == b) { mids.push_back(w);
+}
+            }
+        }
+        return mids;
+    };
+    // 一半查询从出度最大的几个词出发，覆盖长短列表相差悬殊的情况
+    vector<uint32_t> hubs(vertices);
+    iota(hubs.begin(), hubs.end(), 0);
+    sort(hubs.begin(), hubs.end(), [&](uint32_t x, uint32_t y) { return g.outDegree(x) > g.outDegree(y); });
+    hubs.resize(min<size_t>(hubs.size(), 16));
+    size_t mismatches = 0;
+    size_t found = 0;
+    const int queries = 2000;
+    for (int i = 0; i < queries && vertices > 0; ++i) {
+        uint32_t a = i % 2 == 0 ? hubs[rng.below(hubs.size())] : static_cast<uint32_t>(rng.below(vertices));
+        auto b = static_cast<uint32_t>(rng.below(vertices));
+        // 另有一部分查询沿两步随机游走取 b，保证有桥接词
+        if (i % 4 == 3 && g.outDegree(a) > 0) {
+            uint32_t w = g.targets[g.offsets[a] + rng.below(g.outDegree(a))];
+            if (g.outDegree(w) > 0) { b = g.targets[g.offsets[w] + rng.below(g.outDegree(w))];
+}
+        }
+        vector<uint32_t> expected = bruteForce(a, b);
+        // 查两次，第二次命中缓存
+        for (int pass = 0; pass < 2; ++pass) {
+            BridgeResult result = graph.getBridgeWords(a, b);
+            if (vector<uint32_t>(result.begin(), result.end()) != expected) { mismatches++;
+}
+        }
+        found += expected.empty() ? 0 : 1;
+    }
+    report.check("bridge words match brute force", mismatches == 0,
+                 to_string(queries) + " pairs, " + to_string(found) + " with bridges, " + to_string(mismatches) +
+                     " mismatches");
+
+    // 已缓存的查询在加边造出新桥接词后必须失效
+    uint32_t a = hubs.empty() ? 0 : hubs[0];
+    uint32_t b = vertices > 1 ? vertices - 1 : 0;
+    graph.getBridgeWords(a, b);
+    uint32_t bridge = graph.addWord("selftest-bridge");
+    graph.addEdge(a, bridge);
+    graph.addEdge(bridge, b);
+    BridgeResult result = graph.getBridgeWords(a, b);
+    bool invalidated = find(result.begin(), result.end(), bridge) != result.end();
+    report.check("bridge cache is invalidated by addEdge", invalidated);
+
+    // 交互式的生成新文本经过图的桥接词缓存：同一句话第二次生成时全部命中
+    string sentence = graph.wordOf(a) + " " + graph.wordOf(b) + " " + graph.wordOf(a) + " " + graph.wordOf(b);
+    generateNewText(graph, sentence);
+    BridgeCacheStats before = graph.getBridgeCacheStats();
+    generateNewText(graph, sentence);
+    BridgeCacheStats after = graph.getBridgeCacheStats();
+    report.check("generateNewText reuses the bridge cache",
+                 after.hits - before.hits == 3 && after.misses == before.misses);
+}
+
+// 路径的总权重；相邻两点之间没有边时返回 -1
+auto pathWeight(const CsrGraph& g, const vector<uint32_t>& path) -> int64_t {
+    int64_t total = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        size_t e = g.findEdge(path[i], path[i + 1]);
+        if (e == g.edgeCount()) { return -1;
+}
+        total += g.weights[e];
+    }
+    return total;
+}
+
+// 自检用的点对点查询，按源点分组（每组只需一棵最短路径树作对照）：每个源点一半目标随机，
+// 一半取树上可达的点；另外从没有出边的词出发、向没有入边的词查几次，覆盖不可达的情况
+auto selfTestQueries(const CsrGraph& g, size_t sources, size_t perSource, uint64_t seed)
+    -> vector<pair<uint32_t, uint32_t>> {
+    SplitMix64 rng(seed);
+    const auto vertices = static_cast<uint32_t>(g.vertexCount());
+    vector<pair<uint32_t, uint32_t>> queries;
+    if (vertices == 0) { return queries;
+}
+    ShortestPathTree tree;
+    for (size_t i = 0; i < sources; ++i) {
+        auto s = static_cast<uint32_t>(rng.below(vertices));
+        runDijkstra<BinaryHeapQueue>(g, s, tree);
+        for (size_t j = 0; j < perSource; ++j) {
+            auto t = static_cast<uint32_t>(rng.below(vertices));
+            for (int tries = 0; j % 2 == 1 && tries < 16 && !tree.reachable(t); ++tries) {
+                t = static_cast<uint32_t>(rng.below(vertices));
+            }
+            queries.emplace_back(s, t);
+        }
+    }
+    for (uint32_t v = 0, isolated = 0; v < vertices && isolated < 8; ++v) {
+        if (g.outDegree(v) == 0) {
+            queries.emplace_back(v, static_cast<uint32_t>(rng.below(vertices)));
+            isolated++;
+        }
+        if (g.inDegree(v) == 0) {
+            queries.emplace_back(static_cast<uint32_t>(rng.below(vertices)), v);
+            isolated++;
+        }
+    }
+    return queries;
+}
+
+// 双向 Dijkstra（三种队列）返回的路径必须由图中的边组成，总权重等于单源 Dijkstra 的距离，
+// 不可达时两者都报告不可达
+template <class Queue>
+void selfTestBidirectional(const char* name, const CsrGraph& g, const vector<pair<uint32_t, uint32_t>>& queries,
+                           SelfTestReport& report) {
+    BidirectionalDijkstra<Queue> search;
+    ShortestPathTree tree;
+    size_t mismatches = 0;
+    size_t reachable = 0;
+    for (auto [s, t] : queries) {
+        if (tree.source != s) { runDijkstra<BinaryHeapQueue>(g, s, tree);
+}
+        vector<uint32_t> path = search.search(g, s, t);
+        if (!tree.reachable(t)) {
+            mismatches += path.empty() && search.stats().length < 0 ? 0 : 1;
+            continue;
+        }
+        reachable++;
+        bool ok = !path.empty() && path.front() == s && path.back() == t && pathWeight(g, path) == tree.dist[t] &&
+                  search.stats().length == tree.dist[t];
+        mismatches += ok ? 0 : 1;
+    }
+    report.check(string("bidirectional Dijkstra (") + name + ") matches Dijkstra", mismatches == 0,
+                 to_string(queries.size()) + " queries, " + to_string(reachable) + " reachable, " +
+                     to_string(mismatches) + " mismatches");
+}
+
+// ALT 搜索返回的路径与双向 Dijkstra 的检查相同：由图中的边组成，长度等于 Dijkstra 的距离
+template <class Queue>
+void selfTestLandmarkSearch(const string& name, const CsrGraph& g, const LandmarkIndex& index,
+                            const vector<pair<uint32_t, uint32_t>>& queries, SelfTestReport& report) {
+    LandmarkAStar<Queue> search;
+    ShortestPathTree tree;
+    size_t mismatches = 0;
+    for (auto [s, t] : queries) {
+        if (tree.source != s) { runDijkstra<BinaryHeapQueue>(g, s, tree);
+}
+        vector<uint32_t> path = search.search(g, index, s, t);
+        bool ok = tree.reachable(t) ? !path.empty() && path.front() == s && path.back() == t &&
+                                          pathWeight(g, path) == tree.dist[t] && search.stats().length == tree.dist[t]
+                                    : path.empty();
+        mismatches += ok ? 0 : 1;
+    }
+    report.check("ALT (" + name + ") matches Dijkstra", mismatches == 0,
+                 to_string(index.size()) + " landmarks, " + to_string(queries.size()) + " queries, " +
+                     to_string(mismatches) + " mismatches");
+}
+
+// 地标表：刚建好的和保存后重新加载的都要给出正确的距离；重新加载时保留要求的地标数；
+// 截断的文件和地标数被改大的文件都应被拒绝
+void selfTestLandmarks(const CsrGraph& g, const vector<pair<uint32_t, uint32_t>>& queries, SelfTestReport& report) {
+    const unsigned requested = 8;
+    LandmarkIndex index;
+    index.build(g, requested);
+    selfTestLandmarkSearch<RadixHeapQueue>("radix heap", g, index, queries, report);
+    selfTestLandmarkSearch<BinaryHeapQueue>("binary heap", g, index, queries, report);
+
+    const string path = "selftest_landmarks.alt";
+    const uint64_t fingerprint = csrFingerprint(g);
+    LandmarkIndex loaded;
+    bool roundTrip = index.save(path, fingerprint) && loaded.load(path, fingerprint, g.vertexCount()) &&
+                     loaded.size() == index.size() && loaded.requestedSize() == requested;
+    report.check("landmark file round-trips with the requested count", roundTrip);
+    if (roundTrip) { selfTestLandmarkSearch<RadixHeapQueue>("reloaded", g, loaded, queries, report);
+}
+
+    string bytes;
+    {
+        ifstream in(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    auto rejects = [&](const string& contents) {
+        ofstream(path, ios::binary | ios::trunc).write(contents.data(), static_cast<streamsize>(contents.size()));
+        LandmarkIndex damaged;
+        return !damaged.load(path, fingerprint, g.vertexCount()) && damaged.empty();
+    };
+    string truncated = bytes.substr(0, bytes.size() - 1);
+    string inflated = bytes;
+    const uint32_t hugeK = UINT32_MAX;
+    if (inflated.size() >= 16) { memcpy(&inflated[12], &hugeK, sizeof(hugeK));
+}
+    report.check("damaged landmark files are rejected", rejects(truncated) && rejects(inflated));
+    remove(path.c_str());
+}
+
+// Yen 的结果应满足：每条路径由图中的边组成、从 s 到 t、无环且长度正确，各条路径互不相同，
+// 长度按非降序排列，第一条的长度等于 Dijkstra 的距离
+auto checkRankedPaths(const CsrGraph& g, uint32_t s, uint32_t t, const vector<RankedPath>& paths, int64_t shortest)
+    -> bool {
+    set<vector<uint32_t>> distinct;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const auto& vertices = paths[i].vertices;
+        set<uint32_t> visited(vertices.begin(), vertices.end());
+        if (vertices.empty() || vertices.front() != s || vertices.back() != t || visited.size() != vertices.size() ||
+            pathWeight(g, vertices) != paths[i].length || (i > 0 && paths[i].length < paths[i - 1].length) ||
+            !distinct.insert(vertices).second) {
+            return false;
+        }
+    }
+    return paths.empty() ? shortest < 0 : paths.front().length == shortest;
+}
+
+// Yen 的 k 短路：在大图上检查 checkRankedPaths 的各项性质；在许多个小随机图上再与穷举全部
+// 无环路径的结果比较——前 k 条的长度序列必须与穷举得到的最短 k 个长度完全一致
+void selfTestKShortestPaths(const CsrGraph& g, const vector<pair<uint32_t, uint32_t>>& queries,
+                            SelfTestReport& report) {
+    const size_t k = 10;
+    YenKShortestPaths<> yen;
+    ShortestPathTree tree;
+    size_t failures = 0;
+    size_t checked = min<size_t>(queries.size(), 48);
+    for (size_t i = 0; i < checked; ++i) {
+        auto [s, t] = queries[i];
+        if (tree.source != s) { runDijkstra<BinaryHeapQueue>(g, s, tree);
+}
+        int64_t shortest = tree.reachable(t) ? tree.dist[t] : -1;
+        failures += checkRankedPaths(g, s, t, yen.search(g, s, t, k), shortest) ? 0 : 1;
+    }
+    report.check("Yen paths are loopless, valid and ordered", failures == 0,
+                 to_string(checked) + " queries, " + to_string(failures) + " failures");
+
+    SplitMix64 rng(19);
+    size_t mismatches = 0;
+    size_t pairs = 0;
+    for (int round = 0; round < 40; ++round) {
+        Graph small;
+        const uint32_t n = 6 + static_cast<uint32_t>(rng.below(5));
+        for (uint32_t v = 0; v < n; ++v) { small.addWord("v" + to_string(v));
+}
+        for (uint32_t e = 0; e < 3 * n; ++e) {
+            small.addEdge(static_cast<uint32_t>(rng.below(n)), static_cast<uint32_t>(rng.below(n)),
+                          1 + static_cast<int>(rng.below(4)));
+        }
+        const auto& h = small.getCsr();
+        for (uint32_t s = 0; s < n; ++s) {
+            runDijkstra<BinaryHeapQueue>(h, s, tree);
+            for (uint32_t t = 0; t < n; ++t) {
+                if (s == t) { continue;
+}
+                // 深度优先穷举 s -> t 的全部无环路径的长度
+                vector<int64_t> lengths;
+                vector<char> onPath(n, 0);
+                auto enumerate = [&](auto&& self, uint32_t u, int64_t length) -> void {
+                    if (u == t) {
+                        lengths.push_back(length);
+                        return;
+                    }
+                    onPath[u] = 1;
+                    for (uint64_t e = h.offsets[u]; e < h.offsets[u + 1]; ++e) {
+                        if (onPath[h.targets[e]] == 0) { self(self, h.targets[e], length + h.weights[e]);
+}
+                    }
+                    onPath[u] = 0;
+                };
+                enumerate(enumerate, s, 0);
+                sort(lengths.begin(), lengths.end());
+                lengths.resize(min(lengths.size(), k));
+
+                auto paths = yen.search(h, s, t, k);
+                vector<int64_t> found;
+                for (const auto& path : paths) { found.push_back(path.length);
+}
+                int64_t shortest = tree.reachable(t) ? tree.dist[t] : -1;
+                mismatches += found == lengths && checkRankedPaths(h, s, t, paths, shortest) ? 0 : 1;
+                pairs++;
+            }
+        }
+    }
+    report.check("Yen matches exhaustive loopless enumeration", mismatches == 0,
+                 to_string(pairs) + " pairs on 40 random graphs, " + to_string(mismatches) + " mismatches");
+}
+
+// 快照：保存后重新映射，词表、查找、CSR 与 PageRank 都与原图一致；载入的 PageRank 可以直接作为
+// 增量刷新的基准；标成 TF-IDF 随机跳转（llm_1 写的）的 PageRank 段不被采用
+void selfTestSnapshot(const string& filename, SelfTestReport& report) {
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    PageRankOptions options;
+    options.tolerance = 1e-6;
+    options.maxIterations = 1000;
+    graph.calculatePageRank(options);
+    const string path = "selftest_snapshot.bin";
+    Graph loaded;
+    bool saved = graph.saveSnapshot(path) && loaded.loadSnapshot(path);
+
+    const auto& a = graph.getCsr();
+    const auto& b = loaded.getCsr();
+    bool same = saved && loaded.vertexCount() == graph.vertexCount() && b.edgeCount() == a.edgeCount() &&
+                b.maxWeight == a.maxWeight && loaded.pageRankStatus() == PageRankStatus::Ready;
+    for (uint32_t id = 0; same && id < graph.vertexCount(); ++id) {
+        same = loaded.wordView(id) == graph.wordView(id) && loaded.findWord(graph.wordView(id)) == id &&
+               b.offsets[id + 1] == a.offsets[id + 1] && b.inOffsets[id + 1] == a.inOffsets[id + 1] &&
+               loaded.getPageRank(graph.wordOf(id)) == graph.getPageRank(graph.wordOf(id));
+    }
+    for (size_t e = 0; same && e < a.edgeCount(); ++e) {
+        same = b.targets[e] == a.targets[e] && b.weights[e] == a.weights[e] && b.inSources[e] == a.inSources[e] &&
+               b.inWeights[e] == a.inWeights[e];
+    }
+    report.check("snapshot round-trips words, CSR and PageRank", same);
+
+    // 在载入的图上加边后做增量刷新：基准来自快照，结果应与同样加边后的原图完整重算一致
+    SplitMix64 rng(24);
+    const auto vertices = static_cast<uint32_t>(graph.vertexCount());
+    loaded.setIncrementalPageRank(true);
+    for (int i = 0; i < 5; ++i) {
+        auto src = static_cast<uint32_t>(rng.below(vertices));
+        auto dest = static_cast<uint32_t>(rng.below(vertices));
+        loaded.addEdge(src, dest);
+        graph.addEdge(src, dest);
+    }
+    bool incremental = saved && loaded.updatePageRank();
+    PageRankOptions exact = options;
+    exact.tolerance = 1e-14;
+    graph.calculatePageRank(exact);
+    double distance = 0.0;
+    for (uint32_t id = 0; id < vertices; ++id) {
+        distance += fabs(loaded.getPageRank(graph.wordOf(id)) - graph.getPageRank(graph.wordOf(id)));
+    }
+    stringstream detail;
+    detail << (!saved ? "snapshot not reloaded" : incremental ? "push refresh" : "fell back to full recompute")
+           << ", L1 error " << scientific << setprecision(2) << distance;
+    report.check("incremental PageRank works on a loaded snapshot",
+                 incremental && distance <= 2.0 * options.tolerance / (1.0 - options.damping), detail.str());
+
+    // 把标志改成 TF-IDF 随机跳转，PageRank 段应被忽略
+    string bytes;
+    {
+        ifstream in(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    bool ignored = false;
+    if (bytes.size() >= SnapshotLayout::kHeaderBytes) {
+        uint32_t flags = 0;
+        memcpy(&flags, &bytes[12], sizeof(flags));
+        flags |= SnapshotLayout::kTfidfTeleport;
+        memcpy(&bytes[12], &flags, sizeof(flags));
+        ofstream(path, ios::binary | ios::trunc).write(bytes.data(), static_cast<streamsize>(bytes.size()));
+        Graph other;
+        ignored = other.loadSnapshot(path) && other.vertexCount() == graph.vertexCount() && !other.hasPageRank();
+    }
+    report.check("PageRank computed with another teleport variant is ignored", ignored);
+    remove(path.c_str());
+}
+
+void selfTestCorpus(const string& filename, SelfTestReport& report) {
+    selfTestPageRank(filename, report);
+    selfTestIncrementalPageRank(filename, report);
+    selfTestBridgeWords(filename, report);
+    selfTestSnapshot(filename, report);
+
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    const auto& g = graph.getCsr();
+    auto queries = selfTestQueries(g, 16, 24, 11);
+    selfTestBidirectional<RadixHeapQueue>("radix heap", g, queries, report);
+    selfTestBidirectional<BinaryHeapQueue>("binary heap", g, queries, report);
+    selfTestBidirectional<DialQueue>("Dial buckets", g, queries, report);
+    selfTestLandmarks(g, queries, report);
+    selfTestKShortestPaths(g, queries, report);
+}
+
+// 不指定语料时跑合成语料和仓库自带的几份小语料（需在仓库根目录下运行）：
+// 小而稠密的图与大图的行为不同（例如增量 PageRank 的推送会扩散到全图），两类都要覆盖
+auto selfTest(vector<string> corpora) -> int {
+    if (corpora.empty()) {
+        corpora = {"", "1.txt", "Easy_Test.txt", "Easy_Test_2.txt", "hard_text.txt"};
+    }
+    SelfTestReport report;
+    selfTestParallelBuild(report);
+    for (const auto& filename : corpora) {
+        cout << "== " << (filename.empty() ? "synthetic corpus" : filename) << "\n";
+        if (!filename.empty() && !ifstream(filename)) {
+            report.check("corpus is readable", false, "cannot open " + filename);
+            continue;
+        }
+        selfTestCorpus(filename, report);
+    }
+    return report.failures() == 0 ? 0 : 1;
+}
+
+auto main(int argc, char* argv[]) -> int {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <filename> [--no-render] [--landmarks K]\n"
+             << "       " << argv[0] << " --save-snapshot <filename> <snapshot>\n"
+             << "       " << argv[0] << " --self-test [filename...]\n"
+             << "       " << argv[0] << " --bench-tokenize <filename> [MiB]\n"
+             << "       " << argv[0] << " --bench-pagerank <filename> [maxThreads] [iterations]\n"
+             << "       " << argv[0] << " --bench-sssp <filename> [queries] [landmarks]\n"
+             << "       " << argv[0] << " --generate-batch <filename> <inputs> <outputs> [threads] [seed]\n"
+             << "       " << argv[0] << " --distances <filename> <sources|all> <output> [threads]\n"
+             << "       " << argv[0] << " --nearest <filename> <sources|all> <k> <output> [threads]\n"
+             << "       " << argv[0]
+             << " --walks <filename> <output> [walksPerNode] [maxLength] [threads] [seed] [--weighted] [--binary]"
+             << " [--p P] [--q Q]\n";
+        return 1;
+    }
+    if (string(argv[1]) == "--save-snapshot" && argc >= 4) {
+        return saveSnapshot(argv[2], argv[3]);
+    }
+    if (string(argv[1]) == "--self-test") {
+        return selfTest(vector<string>(argv + 2, argv + argc));
+    }
+    if (string(argv[1]) == "--bench-tokenize" && argc >= 3) {
+        return benchTokenize(argv[2], argc >= 4 ? stoul(argv[3]) : 1024);
+    }
+    if (string(argv[1]) == "--bench-pagerank" && argc >= 3) {
+        unsigned maxThreads = argc >= 4 ? stoul(argv[3]) : max(thread::hardware_concurrency(), 1u);
+        return benchPageRank(argv[2], max(maxThreads, 1u), argc >= 5 ? stoi(argv[4]) : 100);
+    }
+    if (string(argv[1]) == "--bench-sssp" && argc >= 3) {
+        return benchShortestPath(argv[2], argc >= 4 ? stoul(argv[3]) : 1000, argc >= 5 ? stoul(argv[4]) : 16);
+    }
+    if (string(argv[1]) == "--distances" && argc >= 5) {
+        unsigned threads = argc >= 6 ? stoul(argv[5]) : max(thread::hardware_concurrency(), 1u);
+        return multiSourcePaths(argv[2], argv[3], 0, argv[4], max(threads, 1u));
+    }
+    if (string(argv[1]) == "--nearest" && argc >= 6) {
+        unsigned threads = argc >= 7 ? stoul(argv[6]) : max(thread::hardware_concurrency(), 1u);
+        return multiSourcePaths(argv[2], argv[3], max<size_t>(stoul(argv[4]), 1), argv[5], max(threads, 1u));
+    }
+    if (string(argv[1]) == "--walks" && argc >= 4) {
+        // --weighted 按共现次数加权选边，--binary 输出二进制格式，--p/--q 为 node2vec 参数；其余参数按位置解析
+        WalkCorpusOptions options;
+        vector<string> positional;
+        for (int i = 2; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--weighted") { options.weighted = true;
+            } else if (arg == "--binary") { options.binary = true;
+            } else if (arg == "--p" && i + 1 < argc) { options.p = stod(argv[++i]);
+            } else if (arg == "--q" && i + 1 < argc) { options.q = stod(argv[++i]);
+            } else { positional.push_back(arg);
+}
+        }
+        if (positional.size() >= 3) { options.walksPerNode = stoul(positional[2]);
+}
+        if (positional.size() >= 4) { options.maxLength = stoul(positional[3]);
+}
+        unsigned threads = positional.size() >= 5 ? stoul(positional[4]) : max(thread::hardware_concurrency(), 1u);
+        if (positional.size() >= 6) { options.seed = stoull(positional[5]);
+}
+        if (options.p <= 0.0 || options.q <= 0.0) {
+            cerr << "--p and --q must be positive\n";
+            return 1;
+        }
+        if (positional.size() >= 2) { return walkCorpus(positional[0], positional[1], options, max(threads, 1u));
+}
+    }
+    if (string(argv[1]) == "--generate-batch" && argc >= 5) {
+        unsigned threads = argc >= 6 ? stoul(argv[5]) : max(thread::hardware_concurrency(), 1u);
+        return generateBatch(argv[2], argv[3], argv[4], max(threads, 1u), argc >= 7 ? stoull(argv[6]) : 0);
+    }
+
+    // 第一个非选项参数是语料文件，也可以是 --save-snapshot 生成的快照；
+    // --no-render 表示路径查询只输出文字，不调用 dot 生成图片；
+    // --landmarks K 为最短路径查询预处理 K 个地标（ALT），地标表保存在 <filename>.alt，下次启动直接加载
+    string filename;
+    bool renderImages = true;
+    unsigned landmarkCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--no-render") { renderImages = false;
+        } else if (arg == "--landmarks" && i + 1 < argc) { landmarkCount = stoul(argv[++i]);
+        } else if (filename.empty()) { filename = arg;
+}
+    }
+
+    Graph graph;
+    if (!TextProcessor::buildGraph(filename, graph)) {
+        cerr << "Cannot open file: " << filename << "\n";
+        return 1;
+    }
+
+    if (landmarkCount > 0) {
+        string landmarkFile = filename + ".alt";
+        // 按要求的地标数比较：图太小时实际选出的地标可能更少，不应因此每次启动都重建
+        if (!graph.loadLandmarks(landmarkFile) || graph.requestedLandmarkCount() != landmarkCount) {
+            graph.buildLandmarks(landmarkCount);
+            if (!graph.saveLandmarks(landmarkFile)) {
+                cerr << "Cannot write file: " << landmarkFile << "\n";
+            }
+        }
+    }
+
+    // PageRank 在后台线程计算，菜单立即可用；查询 PageRank 时如果还没算完就等它结束。
+    // 快照里已经带有 PageRank 时直接使用。之后图有变化时，下一次查询会按同样的参数重新计算
+    PageRankOptions rankOptions;
+    rankOptions.tolerance = 1e-10;  // 收敛即停止，不必固定跑满 100 轮
+    rankOptions.threads = max(thread::hardware_concurrency(), 1u);
+    if (graph.hasPageRank()) {
+        graph.setLazyPageRank(rankOptions);
+    } else {
+        graph.startPageRank(rankOptions);
+    }
+    // 交互模式下游走结果仍写入 random_walk.txt，但由后台线程完成，菜单不必等待文件 I/O
+    graph.setWalkSink(make_unique<AsyncWalkSink>(make_unique<TruncatingFileWalkSink>()));
+
+    while (true) {
+        cout << "\nOptions:\n"
+             << "1. Show directed graph\n"
+             << "2. Export graph to image (PNG)\n"
+             << "3. Query bridge words\n"
+             << "4. Generate new text\n"
+             << "5. Calculate shortest path\n"
+             << "6. Calculate PageRank (" << pageRankStatusText(graph.pageRankStatus(), graph.refreshesPageRankOnQuery()) << ")\n"
+             << "7. Random walk\n"
+             << "8. K shortest paths\n"
+             << "9. Exit\n"
+             << "Choice: ";
+
+        int choice;
+        cin >> choice;
+        cin.ignore();
+
+        switch (choice) {
+            case 1:
+                showDirectedGraph(graph);
+                break;
+            case 2:
+                showDirectedGraph(graph, true);  // 导出为图像
+                break;
+            case 3: {
+                string word1;
+                string word2;
+                cout << "Enter two words: ";
+                cin >> word1 >> word2;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                cout << queryBridgeWords(graph, word1, word2) << endl;
+                break;
+            }
+            case 4: {
+                string input;
+                cout << "Enter text: ";
+                getline(cin, input);
+                cout << generateNewText(graph, input) << endl;
+                break;
+            }
+            case 5: {
+                string word1;
+                string word2;
+                cout << "Enter one or two words: ";
+                cin >> word1;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                
+                // 检查是否有第二个单词输入
+                string line;
+                getline(cin, line);
+                stringstream ss(line);
+                if (ss >> word2) {
+                    // 如果输入了两个单词，计算它们之间的最短路径
+                    transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                    cout << calcShortestPath(graph, word1, word2, renderImages) << endl;
+                } else {
+                    // 如果只输入了一个单词，计算到所有其他单词的最短路径
+                    cout << calcShortestPathToAll(graph, word1, renderImages) << endl;
+                }
+                break;
+            }
+            case 6: {
+                string word;
+                cout << "Enter word: ";
+                cin >> word;
+                transform(word.begin(), word.end(), word.begin(), ::tolower);
+                if (graph.pageRankStatus() == PageRankStatus::Computing) {
+                    cout << "Waiting for the background PageRank computation..." << endl;
+                }
+                cout << "PageRank: " << fixed << setprecision(4) << calcPageRank(graph, word) << endl;
+                break;
+            }
+            case 7:
+                cout << "Random walk: " << randomWalk(graph) << endl;
+                break;
+            case 8: {
+                string word1;
+                string word2;
+                size_t k = 5;
+                cout << "Enter two words and k: ";
+                cin >> word1 >> word2 >> k;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                cout << calcKShortestPaths(graph, word1, word2, k, renderImages) << endl;
+                break;
+            }
+            case 9:
+                return 0;
+            default:
+                cout << "Invalid choice\n";
+        }
+    }
 }
\ No newline at end of file
@@ -1,550 +1,3094 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <map>
-#include <unordered_map>
-#include <queue>
-#include <algorithm>
-#include <random>
-#include <cmath>
-#include <chrono>
-#include <thread>
-#include <stack>
-#include <set>
-#include <iomanip>
-#include <climits>
-#include <unordered_set>
-
-using namespace std;
-
-class Graph {
-private:
-    unordered_map<string, unordered_map<string, int>> adjList;
-    unordered_map<string, double> pageRank;
-    unordered_map<string, unordered_map<string, vector<string>>> bridgeCache;
-    unordered_map<string, double> tfidfScores; // 新增：存储每个单词的TF-IDF值
-
-    // 新增：计算TF-IDF值的辅助函数
-    void calculateTFIDF() {
-        unordered_map<string, int> wordFreq;  // 词频(TF)
-        unordered_map<string, int> wordInDocs; // 包含该词的文档数(IDF)
-        int totalWords = 0;
-
-        // 计算词频
-        for (const auto& [src, edges] : adjList) {
-            wordFreq[src]++;
-            totalWords++;
-            for (const auto& [dest, count] : edges) {
-                wordFreq[dest] += count;
-                totalWords += count;
-            }
-        }
-
-        // 计算每个词出现在多少个"上下文"中
-        // 这里我们将每个词的邻接关系视为一个"文档"
-        for (const auto& [src, edges] : adjList) {
-            wordInDocs[src]++;
-            for (const auto& [dest, _] : edges) {
-                wordInDocs[dest]++;
-            }
-        }
-
-        // 计算TF-IDF
-        double totalDocs = adjList.size();
-        tfidfScores.clear();
-        for (const auto& [word, freq] : wordFreq) {
-            double tf = static_cast<double>(freq) / totalWords;
-            double idf = log(totalDocs / (1 + wordInDocs[word]));
-            tfidfScores[word] = tf * idf;
-        }
-
-        // 归一化TF-IDF值到[0.5, 2.0]范围
-        double maxTFIDF = 0.0;
-        double minTFIDF = numeric_limits<double>::max();
-        for (const auto& [_, score] : tfidfScores) {
-            maxTFIDF = max(maxTFIDF, score);
-            minTFIDF = min(minTFIDF, score);
-        }
-
-        for (auto& [word, score] : tfidfScores) {
-            if (maxTFIDF == minTFIDF) {
-                score = 1.0;  // 如果所有值都相同，设为1.0
-            } else {
-                // 将值映射到[0.5, 2.0]范围
-                score = 0.5 + 1.5 * (score - minTFIDF) / (maxTFIDF - minTFIDF);
-            }
-        }
-    }
-
-public:
-    void addEdge(const string& src, const string& dest) {
-        adjList[src][dest]++;
-    }
-
-    const unordered_map<string, unordered_map<string, int>>& getAdjList() const {
-        return adjList;
-    }
-
-    vector<string> getBridgeWords(const string& word1, const string& word2) {
-        bool word1Exists = adjList.count(word1);
-        bool word2Exists = adjList.count(word2);
-        
-        // 检查单词是否在图中，并给出具体的错误信息
-        if (!word1Exists || !word2Exists) {
-            string errorMsg;
-            if (!word1Exists && !word2Exists) {
-                errorMsg = "No \"" + word1 + "\" and \"" + word2 + "\" in the graph!";
-            } else if (!word1Exists) {
-                errorMsg = "No \"" + word1 + "\" in the graph!";
-            } else {
-                errorMsg = "No \"" + word2 + "\" in the graph!";
-            }
-            return {errorMsg};
-        }
-        
-        vector<string> bridges;
-        for (auto& [mid, _] : adjList[word1]) {
-            if (adjList[mid].count(word2)) {
-                bridges.push_back(mid);
-            }
-        }
-        
-        // 如果没有找到桥接词，返回特殊消息
-        if (bridges.empty()) {
-            return {"No bridge words from \"" + word1 + "\" to \"" + word2 + "\"!"};
-        }
-        
-        return bridges;
-    }
-
-    vector<string> shortestPath(const string& src, const string& dest) {
-        priority_queue<pair<int, string>, vector<pair<int, string>>, greater<>> pq;
-        unordered_map<string, int> dist;
-        unordered_map<string, string> prev;
-
-        for (auto& [node, _] : adjList) dist[node] = INT_MAX;
-        dist[src] = 0;
-        pq.emplace(0, src);
-
-        while (!pq.empty()) {
-            auto [d, u] = pq.top(); pq.pop();
-            if (u == dest) break;
-            for (auto& [v, w] : adjList[u]) {
-                if (dist[v] > dist[u] + w) {
-                    dist[v] = dist[u] + w;
-                    prev[v] = u;
-                    pq.emplace(dist[v], v);
-                }
-            }
-        }
-
-        vector<string> path;
-        if (dist[dest] == INT_MAX) return path;
-        for (string cur = dest; cur != src; cur = prev[cur]) {
-            path.push_back(cur);
-        }
-        path.push_back(src);
-        reverse(path.begin(), path.end());
-        return path;
-    }
-
-    void calculatePageRank(double damping = 0.85, int iterations = 100) {
-        // Step 1: 收集所有节点并计算TF-IDF值
-        unordered_set<string> allNodes;
-        for (const auto& [src, edges] : adjList) {
-            allNodes.insert(src);
-            for (const auto& [dest, _] : edges) {
-                allNodes.insert(dest);
-            }
-        }
-        calculateTFIDF();  // 计算TF-IDF值
-        
-        const double N = allNodes.size();
-        
-        // Step 2: 使用基于TF-IDF的权重初始化PR值
-        unordered_map<string, double> pr;
-        double totalWeight = 0.0;
-        for (const auto& node : allNodes) {
-            totalWeight += tfidfScores[node];
-        }
-        
-        // 使用归一化的TF-IDF值作为初始PR值
-        for (const auto& node : allNodes) {
-            pr[node] = tfidfScores[node] / totalWeight;
-        }
-    
-        // Step 3: 迭代计算
-        for (int i = 0; i < iterations; ++i) {
-            unordered_map<string, double> newPr;
-    
-            // 计算悬挂节点的PR总和（出度为0的节点）
-            double danglingSum = 0.0;
-            for (const auto& node : allNodes) {
-                if (adjList.find(node) == adjList.end() || adjList.at(node).empty()) {
-                    danglingSum += pr[node];
-                }
-            }
-    
-            // 计算每个节点的新PR值
-            for (const auto& node : allNodes) {
-                double sumIn = 0.0;
-                for (const auto& [src, edges] : adjList) {
-                    if (edges.count(node)) {
-                        sumIn += pr[src] / edges.size();
-                    }
-                }
-                // 使用TF-IDF权重影响随机跳转概率
-                double randomJumpProb = (1.0 - damping) * tfidfScores[node] / totalWeight;
-                newPr[node] = randomJumpProb + damping * (sumIn + danglingSum / N);
-            }
-    
-            pr = newPr;
-        }
-    
-        // 保存结果到成员变量
-        pageRank.clear();
-        for (const auto& node : allNodes) {
-            pageRank[node] = pr[node];
-        }
-    }
-
-    double getPageRank(const string& word) {
-        return pageRank.count(word) ? pageRank[word] : 0.0;
-    }
-
-    string randomWalk() {
-        if (adjList.empty()) return "";
-        vector<string> nodes;
-        for (auto& [node, _] : adjList) nodes.push_back(node);
-        static random_device rd;
-        static mt19937 gen(rd());
-        uniform_int_distribution<> dis(0, nodes.size()-1);
-        
-        string current = nodes[dis(gen)];
-        set<pair<string, string>> visitedEdges;
-        vector<string> path;
-        path.push_back(current);
-
-        while (true) {
-            auto& edges = adjList[current];
-            if (edges.empty()) break;
-            
-            vector<string> targets;
-            for (auto& [t, _] : edges) targets.push_back(t);
-            uniform_int_distribution<> edgeDis(0, targets.size()-1);
-            string next = targets[edgeDis(gen)];
-            
-            if (visitedEdges.count({current, next})) break;
-            visitedEdges.insert({current, next});
-            current = next;
-            path.push_back(current);
-        }
-
-        stringstream ss;
-        for (auto& word : path) ss << word << " ";
-        
-        // 将结果保存到文件
-        ofstream outFile("random_walk.txt");
-        if (outFile.is_open()) {
-            outFile << ss.str();
-            outFile.close();
-        }
-        
-        return ss.str();
-    }
-};
-
-class TextProcessor {
-public:
-    static vector<string> processText(const string& filename) {
-        ifstream file(filename);
-        string text;
-        string line;
-        while (getline(file, line)) {
-            text += line + " ";
-        }
-
-        string processed;
-        for (char c : text) {
-            if (isalpha(c)) processed += tolower(c);
-            else processed += ' ';
-        }
-
-        stringstream ss(processed);
-        vector<string> words;
-        string word;
-        while (ss >> word) {
-            words.push_back(word);
-        }
-        return words;
-    }
-};
-
-void exportToDot(const Graph& graph, const string& filename = "graph.dot", 
-                const vector<string>& highlightPath = vector<string>()) {
-    ofstream dotFile(filename);
-    dotFile << "digraph G {\n";
-    dotFile << "  rankdir=LR;\n";  // 设置从左到右的布局
-
-    // 创建用于检查边是否在最短路径上的辅助函数
-    auto isEdgeInPath = [&](const string& src, const string& dest) {
-        if (highlightPath.empty()) return false;
-        for (size_t i = 0; i < highlightPath.size() - 1; ++i) {
-            if (highlightPath[i] == src && highlightPath[i + 1] == dest) {
-                return true;
-            }
-        }
-        return false;
-    };
-
-    const auto& adjList = graph.getAdjList();
-    for (const auto& [src, edges] : adjList) {
-        for (const auto& [dest, weight] : edges) {
-            dotFile << "  \"" << src << "\" -> \"" << dest << "\" [";
-            // 如果边在最短路径上，则用红色标注
-            if (isEdgeInPath(src, dest)) {
-                dotFile << "color=red, penwidth=2.0, ";
-            }
-            dotFile << "label=\"" << weight << "\"];\n";
-        }
-    }
-    dotFile << "}\n";
-    dotFile.close();
-}
-
-// 更新showDirectedGraph函数，添加导出选项
-void showDirectedGraph(const Graph& graph, bool exportImage = false) {
-    // 原有命令行展示逻辑
-    const auto& adjList = graph.getAdjList();
-    cout << "Directed Graph:\n";
-    for (const auto& [src, edges] : adjList) {
-        cout << src << " -> ";
-        for (const auto& [dest, weight] : edges) {
-            cout << dest << "(" << weight << ") ";
-        }
-        cout << "\n";
-    }
-
-    // 导出为图像文件（可选功能）
-    if (exportImage) {
-        exportToDot(graph);
-        (void)system("dot -Tpng graph.dot -o graph.png");
-        cout << "\nGraph image saved to graph.png\n";
-    }
-}
-
-string queryBridgeWords(Graph& graph, const string& word1, const string& word2) {
-    auto bridges = graph.getBridgeWords(word1, word2);
-    
-    // 如果是错误消息，直接返回
-    if (!bridges.empty() && (bridges[0].find("No \"") != string::npos || 
-        bridges[0].find("No bridge words") != string::npos)) {
-        return bridges[0];
-    }
-    
-    stringstream ss;
-    ss << "The bridge words from \"" << word1 << "\" to \"" << word2 << "\" are: ";
-    for (size_t i = 0; i < bridges.size(); ++i) {
-        if (i == bridges.size() - 1) {
-            ss << "and \"" << bridges[i] << "\".";
-        } else if (i == bridges.size() - 2) {
-            ss << "\"" << bridges[i] << "\" ";
-        } else {
-            ss << "\"" << bridges[i] << "\", ";
-        }
-    }
-    return ss.str();
-}
-
-string generateNewText(Graph& graph, const string& input) {
-    vector<string> words;
-    stringstream ss(input);
-    string word;
-    while (ss >> word) {
-        transform(word.begin(), word.end(), word.begin(), ::tolower);
-        words.push_back(word);
-    }
-
-    vector<string> newText;
-    random_device rd;
-    mt19937 gen(rd());
-    
-    for (size_t i = 0; i < words.size(); ++i) {
-        newText.push_back(words[i]);
-        if (i < words.size() - 1) {
-            auto bridges = graph.getBridgeWords(words[i], words[i+1]);
-            // 只在找到有效的桥接词时才添加（排除所有错误消息的情况）
-            if (!bridges.empty() && bridges[0].find("No ") == string::npos) {
-                uniform_int_distribution<> dis(0, bridges.size()-1);
-                newText.push_back(bridges[dis(gen)]);
-            }
-        }
-    }
-
-    stringstream result;
-    for (size_t i = 0; i < newText.size(); ++i) {
-        if (i > 0) result << " ";
-        result << newText[i];
-    }
-    return result.str();
-}
-
-string calcShortestPath(Graph& graph, const string& word1, const string& word2) {
-    auto path = graph.shortestPath(word1, word2);
-    if (path.empty()) return "No path from " + word1 + " to " + word2 + "!";
-    
-    // 导出带有红色标注的路径图
-    exportToDot(graph, "graph.dot", path);
-    system("dot -Tpng graph.dot -o graph.png");
-    
-    stringstream ss;
-    ss << "Shortest path: ";
-    for (size_t i = 0; i < path.size(); ++i) {
-        if (i > 0) ss << " -> ";
-        ss << path[i];
-    }
-    ss << "\nGraph with highlighted path has been saved to graph.png";
-    return ss.str();
-}
-
-// 修改计算单源最短路径的函数
-string calcShortestPathToAll(Graph& graph, const string& source) {
-    const auto& adjList = graph.getAdjList();
-    if (!adjList.count(source)) {
-        return "输入的单词 '" + source + "' 不在图中！";
-    }
-
-    stringstream result;
-    result << "从单词 '" << source << "' 到其他所有单词的最短路径：\n";
-    
-    vector<string> destinations;
-    for (const auto& [dest, _] : adjList) {
-        if (dest != source) {
-            destinations.push_back(dest);
-        }
-    }
-    sort(destinations.begin(), destinations.end());
-
-    for (const string& dest : destinations) {
-        auto path = graph.shortestPath(source, dest);
-        result << "\n到 '" << dest << "' 的最短路径: ";
-        if (path.empty()) {
-            result << "不存在路径";
-        } else {
-            // 为每个路径生成单独的图片
-            string dotFile = "path_" + source + "_to_" + dest + ".dot";
-            string pngFile = "path_" + source + "_to_" + dest + ".png";
-            exportToDot(graph, dotFile, path);
-            system(("dot -Tpng " + dotFile + " -o " + pngFile).c_str());
-            
-            for (size_t i = 0; i < path.size(); ++i) {
-                if (i > 0) result << " -> ";
-                result << path[i];
-            }
-            result << " (查看 " << pngFile << ")";
-        }
-    }
-    
-    return result.str();
-}
-
-double calcPageRank(Graph& graph, const string& word) {
-    return graph.getPageRank(word);
-}
-
-string randomWalk(Graph& graph) {
-    return graph.randomWalk();
-}
-
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <filename>\n";
-        return 1;
-    }
-
-    auto words = TextProcessor::processText(argv[1]);
-    Graph graph;
-    for (size_t i = 0; i < words.size()-1; ++i) {
-        graph.addEdge(words[i], words[i+1]);
-    }
-
-    graph.calculatePageRank();
-
-    while (true) {
-        cout << "\nOptions:\n"
-             << "1. Show directed graph\n"
-             << "2. Export graph to image (PNG)\n"
-             << "3. Query bridge words\n"
-             << "4. Generate new text\n"
-             << "5. Calculate shortest path\n"
-             << "6. Calculate PageRank\n"
-             << "7. Random walk\n"
-             << "8. Exit\n"
-             << "Choice: ";
-
-        int choice;
-        cin >> choice;
-        cin.ignore();
-
-        switch (choice) {
-            case 1:
-                showDirectedGraph(graph);
-                break;
-            case 2:
-                showDirectedGraph(graph, true);  // 导出为图像
-                break;
-            case 3: {
-                string word1, word2;
-                cout << "Enter two words: ";
-                cin >> word1 >> word2;
-                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
-                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
-                cout << queryBridgeWords(graph, word1, word2) << endl;
-                break;
-            }
-            case 4: {
-                string input;
-                cout << "Enter text: ";
-                getline(cin, input);
-                cout << generateNewText(graph, input) << endl;
-                break;
-            }
-            case 5: {
-                string word1, word2;
-                cout << "Enter one or two words: ";
-                cin >> word1;
-                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
-                
-                // 检查是否有第二个单词输入
-                string line;
-                getline(cin, line);
-                stringstream ss(line);
-                if (ss >> word2) {
-                    // 如果输入了两个单词，计算它们之间的最短路径
-                    transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
-                    cout << calcShortestPath(graph, word1, word2) << endl;
-                } else {
-                    // 如果只输入了一个单词，计算到所有其他单词的最短路径
-                    cout << calcShortestPathToAll(graph, word1) << endl;
-                }
-                break;
-            }
-            case 6: {
-                string word;
-                cout << "Enter word: ";
-                cin >> word;
-                transform(word.begin(), word.end(), word.begin(), ::tolower);
-                cout << "PageRank: " << fixed << setprecision(4) << calcPageRank(graph, word) << endl;
-                break;
-            }
-            case 7:
-                cout << "Random walk: " << randomWalk(graph) << endl;
-                break;
-            case 8:
-                return 0;
-            default:
-                cout << "Invalid choice\n";
-        }
-    }
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <queue>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <stack>
+#include <set>
+#include <iomanip>
+#include <climits>
+#include <deque>
+#include <array>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <string_view>
+#include <cstdint>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+// 只读内存映射文件：语料按页由内核换入换出，不需要整份读进堆内存
+class MappedFile {
+public:
+    explicit MappedFile(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0) {
+            opened = true;
+            length = static_cast<size_t>(st.st_size);
+            if (length > 0) {
+                void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) {
+                    opened = false;
+                    length = 0;
+                } else {
+                    base = static_cast<const char*>(addr);
+                    ::madvise(addr, length, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (base != nullptr) ::munmap(const_cast<char*>(base), length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 调整内核的预读策略，例如随机访问的快照用 MADV_RANDOM
+    void advise(int advice) const {
+        if (base != nullptr) ::madvise(const_cast<char*>(base), length, advice);
+    }
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    bool opened = false;
+};
+
+// 只读数组：要么持有自己的 vector，要么直接指向外部内存（例如映射进来的快照文件，由持有映射的一方保证其存活）。
+// CSR 的各个数组用它保存，从快照加载时不必把数据复制到堆上，同一主机上的多个进程共享同一份页缓存
+template <class T>
+class ReadOnlyArray {
+public:
+    ReadOnlyArray() = default;
+    ReadOnlyArray(vector<T> values) : owned(move(values)), first(owned.data()), count(owned.size()) {}
+    ReadOnlyArray(const T* data, size_t size) : first(data), count(size), viewing(true) {}
+
+    ReadOnlyArray(const ReadOnlyArray& other) : owned(other.owned), count(other.count), viewing(other.viewing) {
+        first = viewing ? other.first : owned.data();
+    }
+
+    ReadOnlyArray(ReadOnlyArray&& other) noexcept
+        : owned(move(other.owned)), count(other.count), viewing(other.viewing) {
+        first = viewing ? other.first : owned.data();
+    }
+
+    ReadOnlyArray& operator=(ReadOnlyArray other) noexcept {
+        owned = move(other.owned);
+        count = other.count;
+        viewing = other.viewing;
+        first = viewing ? other.first : owned.data();
+        return *this;
+    }
+
+    ~ReadOnlyArray() = default;
+
+    const T& operator[](size_t i) const { return first[i]; }
+    const T* data() const { return first; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+
+private:
+    vector<T> owned;
+    const T* first = nullptr;
+    size_t count = 0;
+    bool viewing = false;
+};
+
+// 启动 threads 个线程并行执行 task(t)，t 为线程序号；全部结束后返回。threads <= 1 时直接在当前线程执行
+template <class Task>
+void runThreads(unsigned threads, Task&& task) {
+    if (threads <= 1) {
+        task(0u);
+        return;
+    }
+    vector<thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&task, t] { task(t); });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// 可重复使用的线程屏障（C++17 还没有 std::barrier）：count 个线程都到达后一起放行
+class Barrier {
+public:
+    explicit Barrier(unsigned count) : count(count) {}
+
+    void arriveAndWait() {
+        unique_lock<mutex> lock(mtx);
+        size_t current = generation;
+        if (++arrived == count) {
+            arrived = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [&] { return generation != current; });
+    }
+
+private:
+    const unsigned count;
+    unsigned arrived = 0;
+    size_t generation = 0;
+    mutex mtx;
+    condition_variable released;
+};
+
+// SplitMix64：只有 64 位状态的随机数发生器，构造几乎没有开销，适合给每条输入、每次游走单独播种
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1) 内的均匀浮点数（取高 53 位）
+    auto uniform() -> double {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // [0, n) 内的均匀整数（乘法取高位，避免取模）
+    uint64_t below(uint64_t n) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+};
+
+// 单词驻留表：把单词映射为稠密的 uint32 编号，编号按首次出现顺序分配
+class WordInterner {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    uint32_t intern(string_view word) {
+        uint32_t found = find(word);
+        if (found != npos) return found;
+        storage.emplace_back(word);
+        string_view stored = storage.back();
+        auto id = static_cast<uint32_t>(size());
+        words.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    uint32_t find(string_view word) const {
+        if (!baseIndex.empty()) {
+            const size_t mask = baseIndex.size() - 1;
+            for (size_t i = hashWord(word) & mask; baseIndex[i] != npos; i = (i + 1) & mask) {
+                if (baseWord(baseIndex[i]) == word) return baseIndex[i];
+            }
+        }
+        auto it = ids.find(word);
+        return it != ids.end() ? it->second : npos;
+    }
+
+    string_view word(uint32_t id) const {
+        return id < baseCount ? baseWord(id) : words[id - baseCount];
+    }
+
+    size_t size() const {
+        return baseCount + words.size();
+    }
+
+    // 把外部词表（通常映射自快照文件）作为前 offsets.size() - 1 个单词，不复制：第 i 个单词是
+    // blob[offsets[i], offsets[i+1])，index 是 lookupTable() 格式的查找表。只能在空的驻留表上调用，之后仍可继续 intern
+    void attach(const char* blob, ReadOnlyArray<uint64_t> offsets, ReadOnlyArray<uint32_t> index) {
+        baseBlob = blob;
+        baseOffsets = move(offsets);
+        baseIndex = move(index);
+        baseCount = baseOffsets.empty() ? 0 : baseOffsets.size() - 1;
+    }
+
+    // 按 hashWord 线性探测的开放寻址表，槽位数为 2 的幂且不少于单词数的两倍，空槽为 npos。
+    // 写进快照后，加载方直接在映射的表上查找，不必逐词重建哈希表
+    vector<uint32_t> lookupTable() const {
+        size_t slots = 1;
+        while (slots < size() * 2) slots <<= 1;
+        vector<uint32_t> table(slots, npos);
+        for (uint32_t id = 0; id < size(); ++id) {
+            size_t i = hashWord(word(id)) & (slots - 1);
+            while (table[i] != npos) i = (i + 1) & (slots - 1);
+            table[i] = id;
+        }
+        return table;
+    }
+
+    // FNV-1a：结果写进快照文件，所以不能用各实现不同的 std::hash
+    static uint64_t hashWord(string_view word) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : word) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+private:
+    string_view baseWord(uint32_t id) const {
+        return {baseBlob + baseOffsets[id], static_cast<size_t>(baseOffsets[id + 1] - baseOffsets[id])};
+    }
+
+    // attach 进来的单词占据编号 [0, baseCount)，之后 intern 的单词接在后面
+    const char* baseBlob = nullptr;
+    ReadOnlyArray<uint64_t> baseOffsets;
+    ReadOnlyArray<uint32_t> baseIndex;
+    size_t baseCount = 0;
+    deque<string> storage;                    // deque 保证元素地址稳定，string_view 不会失效
+    vector<string_view> words;
+    unordered_map<string_view, uint32_t> ids;
+};
+
+// 冻结后的压缩稀疏行（CSR）邻接表：offsets[u]..offsets[u+1] 是 u 的出边，targets 按编号升序
+struct CsrGraph {
+    ReadOnlyArray<uint64_t> offsets{vector<uint64_t>{0}};
+    ReadOnlyArray<uint32_t> targets;
+    ReadOnlyArray<int> weights;
+    // 反向索引：inOffsets[v]..inOffsets[v+1] 是指向 v 的边，inSources 按编号升序
+    ReadOnlyArray<uint64_t> inOffsets{vector<uint64_t>{0}};
+    ReadOnlyArray<uint32_t> inSources;
+    ReadOnlyArray<int> inWeights;
+    int maxWeight = 0;                   // 最大边权，Dial 桶队列按它分配桶
+
+    size_t vertexCount() const { return offsets.size() - 1; }
+    size_t edgeCount() const { return targets.size(); }
+    size_t outDegree(uint32_t u) const { return offsets[u + 1] - offsets[u]; }
+    size_t inDegree(uint32_t v) const { return inOffsets[v + 1] - inOffsets[v]; }
+
+    // 在有序的出边中二分查找 u->v，返回边下标，不存在时返回 edgeCount()
+    size_t findEdge(uint32_t u, uint32_t v) const {
+        auto first = targets.begin() + static_cast<ptrdiff_t>(offsets[u]);
+        auto last = targets.begin() + static_cast<ptrdiff_t>(offsets[u + 1]);
+        auto it = lower_bound(first, last, v);
+        return (it != last && *it == v) ? static_cast<size_t>(it - targets.begin()) : edgeCount();
+    }
+};
+
+// 有序列表求交，结果追加到 out。长度相近时线性归并；相差悬殊时对短列表的每个元素
+// 在长列表里做倍增（galloping）查找，代价为 O(短 × log(长/短))
+inline void intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, vector<uint32_t>& out) {
+    if (na > nb) {
+        swap(a, b);
+        swap(na, nb);
+    }
+    if (na == 0) return;
+    if (nb / na < 16) {
+        size_t i = 0;
+        size_t j = 0;
+        while (i < na && j < nb) {
+            if (a[i] < b[j]) {
+                ++i;
+            } else if (b[j] < a[i]) {
+                ++j;
+            } else {
+                out.push_back(a[i]);
+                ++i;
+                ++j;
+            }
+        }
+        return;
+    }
+    size_t low = 0;
+    for (size_t i = 0; i < na && low < nb; ++i) {
+        // 从上次的位置开始按 1, 2, 4, ... 步长向后探测，再在最后一段里二分
+        size_t step = 1;
+        size_t high = low;
+        while (high < nb && b[high] < a[i]) {
+            low = high + 1;
+            high += step;
+            step <<= 1;
+        }
+        const uint32_t* it = lower_bound(b + low, b + min(high + 1, nb), a[i]);
+        low = static_cast<size_t>(it - b);
+        if (low < nb && b[low] == a[i]) out.push_back(a[i]);
+    }
+}
+
+// 单源最短路径树：dist[v] 为源点到 v 的距离（不可达为 INT_MAX），prev[v] 为最短路径上 v 的前驱
+struct ShortestPathTree {
+    uint32_t source = UINT32_MAX;
+    vector<int> dist;
+    vector<uint32_t> prev;
+
+    bool reachable(uint32_t v) const { return v < dist.size() && dist[v] != INT_MAX; }
+
+    // 沿前驱回溯出 source -> v 的路径，不可达时返回空
+    vector<uint32_t> pathTo(uint32_t v) const {
+        vector<uint32_t> path;
+        if (!reachable(v)) return path;
+        for (uint32_t cur = v; cur != source; cur = prev[cur]) {
+            path.push_back(cur);
+        }
+        path.push_back(source);
+        reverse(path.begin(), path.end());
+        return path;
+    }
+};
+
+// PageRank 迭代方式：Jacobi 即经典的幂迭代；GaussSeidel 在同一轮内立即使用已经更新过的节点值，通常收敛更快
+enum class PageRankMethod { Jacobi, GaussSeidel };
+
+struct PageRankOptions {
+    double damping = 0.85;
+    int maxIterations = 100;
+    double tolerance = 0.0;      // 相邻两轮 PR 向量的 L1 残差低于该值即停止，0 表示固定跑满 maxIterations
+    PageRankMethod method = PageRankMethod::Jacobi;
+    int aitkenEvery = 0;         // Jacobi 下每隔多少轮做一次 Aitken Δ² 外推，0 表示不外推
+    bool warmStart = false;      // 从上一次的结果出发（图有少量新增边时只需很少几轮）
+    unsigned threads = 1;        // 并行计算的线程数（Gauss-Seidel 总是单线程）
+};
+
+// PageRank 结果的状态：还没有计算、正在后台计算、可用、addEdge 之后已经过期
+enum class PageRankStatus { NotComputed, Computing, Ready, Stale };
+
+// 最近一次 PageRank 计算的收敛情况
+struct PageRankStats {
+    int iterations = 0;
+    bool converged = false;
+    vector<double> residuals;    // 每一轮的 L1 残差
+};
+
+inline uint64_t edgeKey(uint32_t src, uint32_t dest) {
+    return (static_cast<uint64_t>(src) << 32) | dest;
+}
+
+// Dijkstra 的优先队列。边权是正整数，出队的键单调不减，所以可以用整数桶结构代替二叉堆；
+// 搜索函数以模板参数选择队列，接口为 reset / empty / push / top / pop
+
+// 基数堆（radix heap）：第 i 个桶存放与上次出队键 last 的最高不同位为第 i 位的元素。
+// 0 号桶为空时，把第一个非空桶里的元素按新的 last 重新分桶；每个元素最多下沉 32 次，
+// 与边权大小无关
+class RadixHeapQueue {
+public:
+    void reset(int /*maxWeight*/) {
+        for (auto& bucket : buckets) bucket.clear();
+        last = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+
+    void push(int key, uint32_t v) {
+        buckets[bucketOf(key)].emplace_back(key, v);
+        count++;
+    }
+
+    int top() {
+        settle();
+        return last;
+    }
+
+    pair<int, uint32_t> pop() {
+        settle();
+        auto item = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return item;
+    }
+
+private:
+    size_t bucketOf(int key) const {
+        auto diff = static_cast<uint32_t>(key) ^ static_cast<uint32_t>(last);
+        return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    void settle() {
+        if (!buckets[0].empty()) return;
+        size_t i = 1;
+        while (buckets[i].empty()) ++i;
+        last = min_element(buckets[i].begin(), buckets[i].end())->first;
+        for (const auto& item : buckets[i]) {
+            buckets[bucketOf(item.first)].push_back(item);
+        }
+        buckets[i].clear();
+    }
+
+    array<vector<pair<int, uint32_t>>, 33> buckets;
+    int last = 0;
+    size_t count = 0;
+};
+
+// 默认使用的队列
+using PathQueue = RadixHeapQueue;
+
+// 单源 Dijkstra，求出从 s 出发的完整最短路径树。backward 为 true 时沿反向索引搜索，
+// 此时 dist[v] 是 v 到 s 的距离，prev[v] 是 v 在这条路径上的后继
+// 多次调用时传入同一个 queue 与 tree 即可复用它们的内存
+template <class Queue>
+void runDijkstra(const CsrGraph& g, uint32_t s, ShortestPathTree& tree, bool backward, Queue& queue) {
+    const auto& offsets = backward ? g.inOffsets : g.offsets;
+    const auto& neighbors = backward ? g.inSources : g.targets;
+    const auto& weights = backward ? g.inWeights : g.weights;
+    queue.reset(g.maxWeight);
+    tree.source = s;
+    tree.dist.assign(g.vertexCount(), INT_MAX);
+    tree.prev.assign(g.vertexCount(), WordInterner::npos);
+    auto& dist = tree.dist;
+    dist[s] = 0;
+    queue.push(0, s);
+
+    while (!queue.empty()) {
+        auto [d, u] = queue.pop();
+        if (d > dist[u]) continue;
+        for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            uint32_t v = neighbors[e];
+            if (dist[v] > d + weights[e]) {
+                dist[v] = d + weights[e];
+                tree.prev[v] = u;
+                queue.push(dist[v], v);
+            }
+        }
+    }
+}
+
+template <class Queue = PathQueue>
+void runDijkstra(const CsrGraph& g, uint32_t s, ShortestPathTree& tree, bool backward = false) {
+    Queue queue;
+    runDijkstra(g, s, tree, backward, queue);
+}
+
+// 点对点最短路径搜索的统计：出队定点的节点数、松弛的边数与找到的路径长度（不可达为 -1）
+struct PathSearchStats {
+    size_t settled = 0;
+    size_t relaxed = 0;
+    int64_t length = -1;
+};
+
+// 双向搜索一侧的工作区，在多次查询之间复用。dist/parent 只在 stamp[v] 等于当前查询编号时有效，
+// 每次查询只会初始化真正访问到的节点，而不是整张图
+template <class Queue>
+struct SearchFrontier {
+    vector<int> dist;
+    vector<uint32_t> parent;                 // 正向一侧是前驱，反向一侧是后继
+    vector<uint32_t> stamp;
+    Queue queue;
+
+    void prepare(size_t vertexCount, int maxWeight) {
+        if (stamp.size() < vertexCount) {
+            dist.resize(vertexCount);
+            parent.resize(vertexCount);
+            stamp.resize(vertexCount, 0);
+        }
+        queue.reset(maxWeight);
+    }
+
+    int distance(uint32_t v, uint32_t query) const {
+        return stamp[v] == query ? dist[v] : INT_MAX;
+    }
+
+    void reach(uint32_t v, int d, uint32_t from, uint32_t query) {
+        reach(v, d, from, query, d);
+    }
+
+    // priority 是入队的键：Dijkstra 用距离本身，A* 用距离加下界
+    void reach(uint32_t v, int d, uint32_t from, uint32_t query, int priority) {
+        stamp[v] = query;
+        dist[v] = d;
+        parent[v] = from;
+        queue.push(priority, v);
+    }
+};
+
+// 双向 Dijkstra：正向沿出边、反向沿反向索引交替扩展堆顶距离较小的一侧。
+// 松弛到另一侧已经到达的节点时更新经过该点的路径长度 best；两侧堆顶之和不小于 best 时，
+// 不可能再有更短的路径，即可停止
+template <class Queue = PathQueue>
+class BidirectionalDijkstra {
+public:
+    // 返回 s -> t 的节点序列，不可达时为空
+    vector<uint32_t> search(const CsrGraph& g, uint32_t s, uint32_t t) {
+        return search(g, s, t, [](uint32_t, uint32_t) { return true; });
+    }
+
+    // 只走 allow(u, v) 为 true 的边 u -> v（按原图方向），供 k 短路求支路时删点删边
+    template <class EdgeFilter>
+    vector<uint32_t> search(const CsrGraph& g, uint32_t s, uint32_t t, EdgeFilter&& allow) {
+        searchStats = PathSearchStats();
+        if (s == t) {
+            searchStats.length = 0;
+            return {s};
+        }
+        // 查询编号回绕时清空时间戳，避免与很久以前的查询混淆
+        if (++query == 0) {
+            fill(forward.stamp.begin(), forward.stamp.end(), 0);
+            fill(backward.stamp.begin(), backward.stamp.end(), 0);
+            query = 1;
+        }
+        forward.prepare(g.vertexCount(), g.maxWeight);
+        backward.prepare(g.vertexCount(), g.maxWeight);
+        forward.reach(s, 0, WordInterner::npos, query);
+        backward.reach(t, 0, WordInterner::npos, query);
+
+        int64_t best = INT64_MAX;
+        uint32_t meet = WordInterner::npos;
+        while (!forward.queue.empty() && !backward.queue.empty()) {
+            const int forwardTop = forward.queue.top();
+            const int backwardTop = backward.queue.top();
+            if (static_cast<int64_t>(forwardTop) + backwardTop >= best) break;
+            const bool isForward = forwardTop <= backwardTop;
+            SearchFrontier<Queue>& side = isForward ? forward : backward;
+            const SearchFrontier<Queue>& other = isForward ? backward : forward;
+            const auto& offsets = isForward ? g.offsets : g.inOffsets;
+            const auto& neighbors = isForward ? g.targets : g.inSources;
+            const auto& weights = isForward ? g.weights : g.inWeights;
+
+            auto [d, u] = side.queue.pop();
+            if (d > side.dist[u]) continue;
+            searchStats.settled++;
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = neighbors[e];
+                if (!(isForward ? allow(u, v) : allow(v, u))) continue;
+                int nd = d + weights[e];
+                searchStats.relaxed++;
+                if (nd < side.distance(v, query)) {
+                    side.reach(v, nd, u, query);
+                }
+                int rest = other.distance(v, query);
+                if (rest != INT_MAX && static_cast<int64_t>(nd) + rest < best) {
+                    best = static_cast<int64_t>(nd) + rest;
+                    meet = v;
+                }
+            }
+        }
+
+        vector<uint32_t> path;
+        if (meet == WordInterner::npos) return path;
+        searchStats.length = best;
+        for (uint32_t cur = meet; cur != WordInterner::npos; cur = forward.parent[cur]) {
+            path.push_back(cur);
+        }
+        reverse(path.begin(), path.end());
+        for (uint32_t cur = backward.parent[meet]; cur != WordInterner::npos; cur = backward.parent[cur]) {
+            path.push_back(cur);
+        }
+        return path;
+    }
+
+    const PathSearchStats& stats() const { return searchStats; }
+
+private:
+    SearchFrontier<Queue> forward;
+    SearchFrontier<Queue> backward;
+    uint32_t query = 0;
+    PathSearchStats searchStats;
+};
+
+// CSR 的指纹：节点数、边数与全部边（含权重）的 64 位混合哈希，用来判断磁盘上的预处理结果是否对应当前的图
+inline uint64_t csrFingerprint(const CsrGraph& g) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 0x100000001b3ULL; hash ^= hash >> 29; };
+    mix(g.vertexCount());
+    mix(g.edgeCount());
+    for (uint64_t offset : g.offsets) mix(offset);
+    for (size_t e = 0; e < g.edgeCount(); ++e) {
+        mix((static_cast<uint64_t>(g.targets[e]) << 32) | static_cast<uint32_t>(g.weights[e]));
+    }
+    return hash;
+}
+
+// ALT 的地标表：对每个地标 L 记下 d(L, v) 与 d(v, L)，按节点连续存放（[v * K + k]），
+// 查询时由三角不等式给出到目标的距离下界
+class LandmarkIndex {
+public:
+    // 第一个地标取度数最大的节点，之后每次取与已选地标"往返距离"最小值最大的节点（farthest 选法）
+    void build(const CsrGraph& g, unsigned count) {
+        clear();
+        const size_t V = g.vertexCount();
+        requested = count;
+        if (V == 0 || count == 0) return;
+        vertices = V;
+        vector<vector<int>> from;
+        vector<vector<int>> to;
+        vector<int> spread(V, INT_MAX);
+        uint32_t next = 0;
+        for (uint32_t v = 1; v < V; ++v) {
+            if (g.outDegree(v) + g.inDegree(v) > g.outDegree(next) + g.inDegree(next)) next = v;
+        }
+        ShortestPathTree tree;
+        while (landmarks.size() < count) {
+            landmarks.push_back(next);
+            runDijkstra(g, next, tree);
+            from.push_back(tree.dist);
+            runDijkstra(g, next, tree, true);
+            to.push_back(tree.dist);
+
+            int farthest = 0;
+            for (uint32_t v = 0; v < V; ++v) {
+                if (from.back()[v] != INT_MAX && to.back()[v] != INT_MAX) {
+                    spread[v] = min(spread[v], from.back()[v] + to.back()[v]);
+                }
+                if (spread[v] != INT_MAX && spread[v] > farthest) {
+                    farthest = spread[v];
+                    next = v;
+                }
+            }
+            // 剩下的节点都已经是地标或与地标不连通，再加地标没有意义
+            if (farthest == 0) break;
+        }
+
+        const size_t K = landmarks.size();
+        fromLandmark.resize(V * K);
+        toLandmark.resize(V * K);
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t v = 0; v < V; ++v) {
+                fromLandmark[v * K + k] = from[k][v];
+                toLandmark[v * K + k] = to[k][v];
+            }
+        }
+    }
+
+    void clear() {
+        landmarks.clear();
+        fromLandmark.clear();
+        toLandmark.clear();
+        vertices = 0;
+        requested = 0;
+    }
+
+    bool empty() const { return landmarks.empty(); }
+    size_t size() const { return landmarks.size(); }
+    // build 时要求的地标数；图太小或不连通时实际选出的 size() 可能更少
+    unsigned requestedSize() const { return requested; }
+
+    // d(v, t) 的下界：d(L, t) - d(L, v) 与 d(v, L) - d(t, L) 中的最大值。
+    // t 能到达某个地标而 v 不能时，v 一定到不了 t，返回 INT_MAX
+    int lowerBound(uint32_t v, uint32_t t) const {
+        const size_t K = landmarks.size();
+        const int* fromV = fromLandmark.data() + v * K;
+        const int* fromT = fromLandmark.data() + t * K;
+        const int* toV = toLandmark.data() + v * K;
+        const int* toT = toLandmark.data() + t * K;
+        int bound = 0;
+        for (size_t k = 0; k < K; ++k) {
+            if (fromT[k] != INT_MAX && fromV[k] != INT_MAX) {
+                bound = max(bound, fromT[k] - fromV[k]);
+            }
+            if (toT[k] != INT_MAX) {
+                if (toV[k] == INT_MAX) return INT_MAX;
+                bound = max(bound, toV[k] - toT[k]);
+            }
+        }
+        return bound;
+    }
+
+    // 文件格式：魔数、版本、地标数、要求的地标数、节点数、图指纹，之后是地标编号与两张距离表
+    bool save(const string& path, uint64_t fingerprint) const {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+        const uint32_t K = landmarks.size();
+        const uint64_t V = vertices;
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        out.write(reinterpret_cast<const char*>(&K), sizeof(K));
+        out.write(reinterpret_cast<const char*>(&requested), sizeof(requested));
+        out.write(reinterpret_cast<const char*>(&V), sizeof(V));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        out.write(reinterpret_cast<const char*>(landmarks.data()), static_cast<streamsize>(K * sizeof(uint32_t)));
+        out.write(reinterpret_cast<const char*>(fromLandmark.data()), static_cast<streamsize>(fromLandmark.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(toLandmark.data()), static_cast<streamsize>(toLandmark.size() * sizeof(int)));
+        return static_cast<bool>(out);
+    }
+
+    // 文件不存在、格式不符、长度与头部不一致或指纹与当前的图不一致时返回 false，原有的表保持不变
+    bool load(const string& path, uint64_t fingerprint, size_t vertexCount) {
+        ifstream in(path, ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        uint32_t version = 0;
+        uint32_t K = 0;
+        uint32_t requestedK = 0;
+        uint64_t V = 0;
+        uint64_t stored = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&K), sizeof(K));
+        in.read(reinterpret_cast<char*>(&requestedK), sizeof(requestedK));
+        in.read(reinterpret_cast<char*>(&V), sizeof(V));
+        in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        if (!in || memcmp(magic, kMagic, sizeof(kMagic)) != 0 || version != kVersion || V != vertexCount ||
+            stored != fingerprint || K > V || K > requestedK) {
+            return false;
+        }
+        // 先核对剩余长度，再按头部给出的大小分配，损坏或截断的文件不会触发巨大的分配
+        const auto header = in.tellg();
+        in.seekg(0, ios::end);
+        const auto remaining = static_cast<uint64_t>(in.tellg() - header);
+        in.seekg(header);
+        if (remaining != K * sizeof(uint32_t) + 2 * V * K * sizeof(int)) return false;
+        LandmarkIndex loaded;
+        loaded.vertices = V;
+        loaded.requested = requestedK;
+        loaded.landmarks.resize(K);
+        loaded.fromLandmark.resize(V * K);
+        loaded.toLandmark.resize(V * K);
+        in.read(reinterpret_cast<char*>(loaded.landmarks.data()), static_cast<streamsize>(K * sizeof(uint32_t)));
+        in.read(reinterpret_cast<char*>(loaded.fromLandmark.data()), static_cast<streamsize>(V * K * sizeof(int)));
+        in.read(reinterpret_cast<char*>(loaded.toLandmark.data()), static_cast<streamsize>(V * K * sizeof(int)));
+        if (!in) return false;
+        *this = move(loaded);
+        return true;
+    }
+
+private:
+    static constexpr char kMagic[8] = {'W', 'G', 'A', 'L', 'T', 'I', 'D', 'X'};
+    static constexpr uint32_t kVersion = 2;
+
+    vector<uint32_t> landmarks;
+    size_t vertices = 0;
+    uint32_t requested = 0;
+    vector<int> fromLandmark;   // [v * K + k] = d(landmarks[k], v)
+    vector<int> toLandmark;     // [v * K + k] = d(v, landmarks[k])
+};
+
+// 以地标下界为势函数的双向 A*（ALT）。正反两侧使用平均势函数
+// p(v) = (πf(v) - πr(v)) / 2，其中 πf(v) 是 d(v, t) 的下界、πr(v) 是 d(s, v) 的下界，
+// 两侧的约化边权都非负，停止条件与双向 Dijkstra 相同。为保持整数，键统一乘以 2：
+// 正向键 2·df(v) + (πf - πr)，反向键 2·dr(v) - (πf - πr)，二者都非负且单调不减。
+// 但一条边让键增加的量最多可达 4 × 最大边权，所以队列不能假设键的跨度在 maxWeight 以内，
+// 只能用不限制键跨度的基数堆。
+// 某一侧的下界为 INT_MAX 说明 v 不可能在 s -> t 的路径上，直接剪掉
+template <class Queue = PathQueue>
+class LandmarkAStar {
+    static_assert(is_same_v<Queue, RadixHeapQueue>,
+                  "ALT keys can jump by up to 4 * maxWeight, so the queue must not bound the key range");
+
+public:
+    vector<uint32_t> search(const CsrGraph& g, const LandmarkIndex& index, uint32_t s, uint32_t t) {
+        searchStats = PathSearchStats();
+        vector<uint32_t> path;
+        if (s == t) {
+            searchStats.length = 0;
+            return {s};
+        }
+        if (++query == 0) {
+            fill(forward.stamp.begin(), forward.stamp.end(), 0);
+            fill(backward.stamp.begin(), backward.stamp.end(), 0);
+            fill(potentialStamp.begin(), potentialStamp.end(), 0);
+            query = 1;
+        }
+        forward.prepare(g.vertexCount(), g.maxWeight);
+        backward.prepare(g.vertexCount(), g.maxWeight);
+        if (potentialStamp.size() < g.vertexCount()) {
+            potential.resize(g.vertexCount());
+            potentialStamp.resize(g.vertexCount(), 0);
+        }
+        source = s;
+        target = t;
+        const int sourcePotential = potentialOf(index, s);
+        const int targetPotential = potentialOf(index, t);
+        if (sourcePotential == INT_MAX || targetPotential == INT_MAX) return path;
+        forward.reach(s, 0, WordInterner::npos, query, sourcePotential);
+        backward.reach(t, 0, WordInterner::npos, query, -targetPotential);
+
+        int64_t best = INT64_MAX;
+        uint32_t meet = WordInterner::npos;
+        while (!forward.queue.empty() && !backward.queue.empty()) {
+            const int forwardTop = forward.queue.top();
+            const int backwardTop = backward.queue.top();
+            if (best != INT64_MAX && static_cast<int64_t>(forwardTop) + backwardTop >= 2 * best) break;
+            const bool isForward = forwardTop <= backwardTop;
+            const int sign = isForward ? 1 : -1;
+            SearchFrontier<Queue>& side = isForward ? forward : backward;
+            const SearchFrontier<Queue>& other = isForward ? backward : forward;
+            const auto& offsets = isForward ? g.offsets : g.inOffsets;
+            const auto& neighbors = isForward ? g.targets : g.inSources;
+            const auto& weights = isForward ? g.weights : g.inWeights;
+
+            auto [key, u] = side.queue.pop();
+            const int d = side.dist[u];
+            if (key > 2 * d + sign * potential[u]) continue;
+            searchStats.settled++;
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t v = neighbors[e];
+                int nd = d + weights[e];
+                searchStats.relaxed++;
+                int p = potentialOf(index, v);
+                if (p == INT_MAX) continue;
+                if (nd < side.distance(v, query)) {
+                    side.reach(v, nd, u, query, 2 * nd + sign * p);
+                }
+                int rest = other.distance(v, query);
+                if (rest != INT_MAX && static_cast<int64_t>(nd) + rest < best) {
+                    best = static_cast<int64_t>(nd) + rest;
+                    meet = v;
+                }
+            }
+        }
+
+        if (meet == WordInterner::npos) return path;
+        searchStats.length = best;
+        for (uint32_t cur = meet; cur != WordInterner::npos; cur = forward.parent[cur]) {
+            path.push_back(cur);
+        }
+        reverse(path.begin(), path.end());
+        for (uint32_t cur = backward.parent[meet]; cur != WordInterner::npos; cur = backward.parent[cur]) {
+            path.push_back(cur);
+        }
+        return path;
+    }
+
+    const PathSearchStats& stats() const { return searchStats; }
+
+private:
+    // πf(v) - πr(v)，每次查询对每个节点只算一次；v 不可能在路径上时为 INT_MAX
+    int potentialOf(const LandmarkIndex& index, uint32_t v) {
+        if (potentialStamp[v] != query) {
+            potentialStamp[v] = query;
+            int toTarget = index.lowerBound(v, target);
+            int fromSource = index.lowerBound(source, v);
+            potential[v] = (toTarget == INT_MAX || fromSource == INT_MAX) ? INT_MAX : toTarget - fromSource;
+        }
+        return potential[v];
+    }
+
+    SearchFrontier<Queue> forward;
+    SearchFrontier<Queue> backward;
+    vector<int> potential;
+    vector<uint32_t> potentialStamp;
+    uint32_t query = 0;
+    uint32_t source = 0;
+    uint32_t target = 0;
+    PathSearchStats searchStats;
+};
+
+// k 短路中的一条：节点序列与总权重
+struct RankedPath {
+    vector<uint32_t> vertices;
+    int64_t length = 0;
+};
+
+// Yen 算法求前 k 条无环最短路径。候选路径放在一棵前缀树里，每个树节点只记顶点、父节点和
+// 从起点到此的长度，候选之间以及候选与已选路径共享相同的前缀，不必各自复制整条路径。
+// 按 Lawler 的改进，每条新选出的路径只从它的偏离点开始求支路，偏离点之前的支路在处理它的
+// 前一条路径时已经求过。支路用带删边过滤的双向 Dijkstra 搜索，工作区在各次搜索间复用
+template <class Queue = PathQueue>
+class YenKShortestPaths {
+public:
+    vector<RankedPath> search(const CsrGraph& g, uint32_t s, uint32_t t, size_t k) {
+        vector<RankedPath> accepted;
+        nodes.clear();
+        seen.clear();
+        candidates.clear();
+        if (k == 0) return accepted;
+        auto first = spurSearch.search(g, s, t);
+        if (first.empty()) return accepted;
+        uint32_t tail = extend(g, WordInterner::npos, first);
+        addCandidate(tail, 0);
+        if (blockStamp.size() < g.vertexCount()) blockStamp.resize(g.vertexCount(), 0);
+
+        vector<uint32_t> chain;
+        vector<uint32_t> blockedNext;
+        while (accepted.size() < k && !candidates.empty()) {
+            pop_heap(candidates.begin(), candidates.end(), greater<>());
+            Candidate best = candidates.back();
+            candidates.pop_back();
+
+            chain.clear();
+            for (uint32_t node = best.tail; node != WordInterner::npos; node = nodes[node].parent) {
+                chain.push_back(node);
+            }
+            reverse(chain.begin(), chain.end());
+            RankedPath path;
+            path.length = best.length;
+            for (uint32_t node : chain) {
+                path.vertices.push_back(nodes[node].vertex);
+            }
+            accepted.push_back(move(path));
+            if (accepted.size() == k) break;
+
+            const auto& p = accepted.back().vertices;
+            for (size_t i = best.deviation; i + 1 < p.size(); ++i) {
+                const uint32_t spurVertex = p[i];
+                // 根路径上除支点以外的节点都不能再经过，保证无环
+                if (++blockQuery == 0) {
+                    fill(blockStamp.begin(), blockStamp.end(), 0);
+                    blockQuery = 1;
+                }
+                for (size_t j = 0; j < i; ++j) {
+                    blockStamp[p[j]] = blockQuery;
+                }
+                // 与当前路径根部相同的已选路径，在支点处走过的边都要删掉
+                blockedNext.clear();
+                for (const auto& other : accepted) {
+                    if (other.vertices.size() > i + 1 && equal(p.begin(), p.begin() + static_cast<ptrdiff_t>(i) + 1, other.vertices.begin())) {
+                        blockedNext.push_back(other.vertices[i + 1]);
+                    }
+                }
+                auto spur = spurSearch.search(g, spurVertex, t, [&](uint32_t u, uint32_t v) {
+                    if (blockStamp[u] == blockQuery || blockStamp[v] == blockQuery) return false;
+                    return u != spurVertex || find(blockedNext.begin(), blockedNext.end(), v) == blockedNext.end();
+                });
+                if (spur.empty()) continue;
+                size_t before = nodes.size();
+                uint32_t candidate = extend(g, chain[i], spur);
+                if (!addCandidate(candidate, i)) {
+                    nodes.resize(before);
+                }
+            }
+        }
+        return accepted;
+    }
+
+private:
+    struct PrefixNode {
+        uint32_t vertex;
+        uint32_t parent;
+        int64_t length;
+        uint64_t hash;     // 从起点到此的顶点序列的哈希，用于候选去重
+    };
+
+    struct Candidate {
+        int64_t length;
+        uint32_t tail;
+        size_t deviation;  // 偏离点（支点）在路径中的位置
+
+        bool operator>(const Candidate& other) const {
+            return length != other.length ? length > other.length : tail > other.tail;
+        }
+    };
+
+    // 把 vertices[1..]（parent 为 npos 时从 vertices[0] 开始）接到前缀树节点 parent 之后，返回新的末端节点
+    uint32_t extend(const CsrGraph& g, uint32_t parent, const vector<uint32_t>& vertices) {
+        for (size_t i = parent == WordInterner::npos ? 0 : 1; i < vertices.size(); ++i) {
+            PrefixNode node{vertices[i], parent, 0, 0xcbf29ce484222325ULL};
+            if (parent != WordInterner::npos) {
+                const PrefixNode& prev = nodes[parent];
+                node.length = prev.length + g.weights[g.findEdge(prev.vertex, node.vertex)];
+                node.hash = prev.hash;
+            }
+            node.hash = (node.hash ^ node.vertex) * 0x100000001b3ULL;
+            nodes.push_back(node);
+            parent = static_cast<uint32_t>(nodes.size() - 1);
+        }
+        return parent;
+    }
+
+    // 与已有候选（包括已选出的路径）重复时返回 false
+    bool addCandidate(uint32_t tail, size_t deviation) {
+        auto& sameHash = seen[nodes[tail].hash];
+        for (uint32_t other : sameHash) {
+            if (samePath(tail, other)) return false;
+        }
+        sameHash.push_back(tail);
+        candidates.push_back({nodes[tail].length, tail, deviation});
+        push_heap(candidates.begin(), candidates.end(), greater<>());
+        return true;
+    }
+
+    bool samePath(uint32_t a, uint32_t b) const {
+        while (a != WordInterner::npos && b != WordInterner::npos) {
+            if (a == b) return true;
+            if (nodes[a].vertex != nodes[b].vertex) return false;
+            a = nodes[a].parent;
+            b = nodes[b].parent;
+        }
+        return a == b;
+    }
+
+    BidirectionalDijkstra<Queue> spurSearch;
+    vector<PrefixNode> nodes;
+    unordered_map<uint64_t, vector<uint32_t>> seen;
+    vector<Candidate> candidates;     // 以 greater<> 维护的小根堆
+    vector<uint32_t> blockStamp;
+    uint32_t blockQuery = 0;
+};
+
+// 开放寻址的 64 位键集合，用来记录一次游走走过的边（键为 edgeKey）。槽位的代数（stamp）
+// 与当前代数不同即视为空，clear() 只需递增代数，反复清空不必重新填充数组，容量也会保留下来
+class EdgeSet {
+public:
+    void clear() {
+        if (++generation == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+        count = 0;
+    }
+
+    // 插入 key，已经存在时返回 false
+    bool insert(uint64_t key) {
+        if ((count + 1) * 2 > keys.size()) grow();
+        const size_t mask = keys.size() - 1;
+        for (size_t i = hashOf(key) & mask;; i = (i + 1) & mask) {
+            if (stamps[i] != generation) {
+                stamps[i] = generation;
+                keys[i] = key;
+                count++;
+                return true;
+            }
+            if (keys[i] == key) return false;
+        }
+    }
+
+    size_t size() const { return count; }
+
+private:
+    static size_t hashOf(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    // 容量翻倍（至少 64 个槽位），把当前代数的键重新放入
+    void grow() {
+        vector<uint64_t> oldKeys = move(keys);
+        vector<uint32_t> oldStamps = move(stamps);
+        keys.assign(max<size_t>(64, oldKeys.size() * 2), 0);
+        stamps.assign(keys.size(), 0);
+        const size_t mask = keys.size() - 1;
+        for (size_t j = 0; j < oldKeys.size(); ++j) {
+            if (oldStamps[j] != generation) continue;
+            size_t i = hashOf(oldKeys[j]) & mask;
+            while (stamps[i] == generation) i = (i + 1) & mask;
+            stamps[i] = generation;
+            keys[i] = oldKeys[j];
+        }
+    }
+
+    vector<uint64_t> keys;
+    vector<uint32_t> stamps;
+    uint32_t generation = 1;
+    size_t count = 0;
+};
+
+// 一次游走的工作区：走过的边与节点序列。同一个 scratch 反复使用时，游走本身不再分配内存
+struct WalkScratch {
+    EdgeSet visited;
+    vector<uint32_t> path;
+};
+
+// 按边权采样出边的别名表（Vose 方法），与 CSR 的边一一对应：抽到 u 的第 i 条出边（下标 e）后，
+// 以 threshold[e] / 2^32 的概率保留 i，否则改取 alias[e]，每一步都是 O(1)
+struct AliasTables {
+    vector<uint32_t> threshold;
+    vector<uint32_t> alias;
+    vector<double> totals;      // 每个节点出边的边权之和
+
+    void build(const CsrGraph& g) {
+        threshold.assign(g.edgeCount(), UINT32_MAX);
+        alias.assign(g.edgeCount(), 0);
+        totals.assign(g.vertexCount(), 0.0);
+        vector<double> scaled;
+        vector<uint32_t> small;
+        vector<uint32_t> large;
+        for (uint32_t u = 0; u < g.vertexCount(); ++u) {
+            const uint64_t base = g.offsets[u];
+            const size_t degree = g.outDegree(u);
+            if (degree == 0) continue;
+            double total = 0.0;
+            for (size_t i = 0; i < degree; ++i) total += g.weights[base + i];
+            totals[u] = total;
+            scaled.resize(degree);
+            small.clear();
+            large.clear();
+            for (size_t i = 0; i < degree; ++i) {
+                scaled[i] = g.weights[base + i] * static_cast<double>(degree) / total;
+                (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+            }
+            while (!small.empty() && !large.empty()) {
+                uint32_t less = small.back();
+                small.pop_back();
+                uint32_t more = large.back();
+                threshold[base + less] = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+                alias[base + less] = more;
+                scaled[more] -= 1.0 - scaled[less];
+                if (scaled[more] < 1.0) {
+                    large.pop_back();
+                    small.push_back(more);
+                }
+            }
+            // 剩下的（包括浮点误差留下的）都以概率 1 保留自己
+            for (uint32_t i : small) alias[base + i] = i;
+            for (uint32_t i : large) alias[base + i] = i;
+        }
+    }
+
+    // base 为节点的第一条出边下标，i 为均匀抽到的出边序号，random32 为 32 位随机数
+    uint64_t sample(uint64_t base, uint64_t i, uint32_t random32) const {
+        return random32 < threshold[base + i] ? i : alias[base + i];
+    }
+};
+
+// 游走结果的去向：randomWalk 每得到一条游走就调用一次 write
+class WalkSink {
+public:
+    virtual ~WalkSink() = default;
+    virtual void write(string_view walk) = 0;
+    // 等到之前写入的游走都已交给底层，返回这些写入是否全部成功
+    virtual bool flush() { return true; }
+};
+
+// 丢弃结果
+class NullWalkSink : public WalkSink {
+public:
+    void write(string_view /*walk*/) override {}
+};
+
+// 每次写入都截断重写文件，文件里只有最近一条游走。这是 randomWalk 原来写 random_walk.txt 的行为，也是默认的去向
+class TruncatingFileWalkSink : public WalkSink {
+public:
+    explicit TruncatingFileWalkSink(string path = "random_walk.txt") : path(move(path)) {}
+
+    void write(string_view walk) override {
+        ofstream out(path);
+        out << walk;
+        ok = ok && static_cast<bool>(out);
+    }
+
+    bool flush() override { return ok; }
+
+private:
+    string path;
+    bool ok = true;
+};
+
+// 把写入转交给后台线程，由它调用 target 完成真正的 I/O。队列最多暂存 capacity 条游走，
+// 满了以后 write 阻塞等待，内存占用有上限。析构时先写完队列里剩下的游走
+class AsyncWalkSink : public WalkSink {
+public:
+    explicit AsyncWalkSink(unique_ptr<WalkSink> target, size_t capacity = 1024)
+        : target(move(target)), capacity(max<size_t>(capacity, 1)), writer([this] { run(); }) {}
+
+    ~AsyncWalkSink() override {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        changed.notify_all();
+        writer.join();
+    }
+
+    AsyncWalkSink(const AsyncWalkSink&) = delete;
+    AsyncWalkSink& operator=(const AsyncWalkSink&) = delete;
+
+    void write(string_view walk) override {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return queue.size() < capacity; });
+        queue.emplace_back(walk);
+        changed.notify_all();
+    }
+
+    bool flush() override {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return queue.empty() && !busy; });
+        return target->flush();
+    }
+
+private:
+    void run() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            changed.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) break;
+            string walk = move(queue.front());
+            queue.pop_front();
+            busy = true;
+            changed.notify_all();
+            lock.unlock();
+            target->write(walk);
+            lock.lock();
+            busy = false;
+            changed.notify_all();
+        }
+    }
+
+    unique_ptr<WalkSink> target;
+    const size_t capacity;
+    mutex mtx;
+    condition_variable changed;
+    deque<string> queue;
+    bool busy = false;
+    bool stopping = false;
+    thread writer;  // 最后初始化：线程启动时其余成员都已就绪
+};
+
+// 桥接词查询的结果状态
+enum class BridgeStatus { Found, NoBridge, MissingWord1, MissingWord2, MissingBoth };
+
+// 桥接词查询结果：status 为 Found 时 [ids, ids + count) 是按编号升序的桥接词。
+// ids 指向图内部的缓存，在下一次桥接词查询或 addEdge 之前有效
+struct BridgeResult {
+    BridgeStatus status = BridgeStatus::NoBridge;
+    const uint32_t* ids = nullptr;
+    size_t count = 0;
+
+    bool found() const { return status == BridgeStatus::Found; }
+    size_t size() const { return count; }
+    uint32_t operator[](size_t i) const { return ids[i]; }
+    const uint32_t* begin() const { return ids; }
+    const uint32_t* end() const { return ids + count; }
+};
+
+// 桥接词结果的 LRU 缓存，以 (word1, word2) 编号对为键，按估算的内存占用设上限。
+// 结果只取决于 word1 的出边和 word2 的入边，所以每个节点记一个出边/入边版本号，
+// addEdge 时递增两端的版本号；条目记录写入时的版本号，查到版本不一致即视为失效
+class BridgeCache {
+public:
+    explicit BridgeCache(size_t capacityBytes = 8u << 20) : capacity(capacityBytes) {}
+
+    // 命中时返回缓存的结果，未命中或已失效时返回 nullptr
+    const vector<uint32_t>* find(uint32_t word1, uint32_t word2) {
+        auto it = index.find(edgeKey(word1, word2));
+        if (it == index.end()) return nullptr;
+        auto entry = it->second;
+        if (entry->outVersion != versionOf(outVersions, word1) || entry->inVersion != versionOf(inVersions, word2)) {
+            erase(entry);
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, entry);
+        return &entry->ids;
+    }
+
+    const vector<uint32_t>& insert(uint32_t word1, uint32_t word2, vector<uint32_t> ids) {
+        uint64_t key = edgeKey(word1, word2);
+        auto it = index.find(key);
+        if (it != index.end()) erase(it->second);
+        lru.push_front({key, versionOf(outVersions, word1), versionOf(inVersions, word2), move(ids)});
+        index.emplace(key, lru.begin());
+        used += footprint(lru.front());
+        // 至少保留刚插入的条目，即使它本身就超过了上限
+        while (used > capacity && lru.size() > 1) erase(prev(lru.end()));
+        return lru.front().ids;
+    }
+
+    // src -> dest 新增或加重了一条边：src 的出边、dest 的入边发生变化。
+    // 缓存为空时没有需要失效的条目，直接跳过，建图阶段的大量 addEdge 不必付出代价
+    void touch(uint32_t src, uint32_t dest) {
+        if (lru.empty()) return;
+        bump(outVersions, src);
+        bump(inVersions, dest);
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t outVersion;
+        uint32_t inVersion;
+        vector<uint32_t> ids;
+    };
+    using EntryIter = list<Entry>::iterator;
+
+    // 链表节点、哈希表节点与结果数组的大致开销
+    static size_t footprint(const Entry& entry) {
+        return sizeof(Entry) + 2 * sizeof(void*) + sizeof(pair<uint64_t, EntryIter>) + 2 * sizeof(void*) +
+               entry.ids.capacity() * sizeof(uint32_t);
+    }
+
+    static uint32_t versionOf(const vector<uint32_t>& versions, uint32_t v) {
+        return v < versions.size() ? versions[v] : 0;
+    }
+
+    static void bump(vector<uint32_t>& versions, uint32_t v) {
+        if (v >= versions.size()) versions.resize(v + 1, 0);
+        versions[v]++;
+    }
+
+    void erase(EntryIter entry) {
+        used -= footprint(*entry);
+        index.erase(entry->key);
+        lru.erase(entry);
+    }
+
+    size_t capacity;
+    size_t used = 0;
+    list<Entry> lru;                               // 表头为最近使用的条目
+    unordered_map<uint64_t, EntryIter> index;
+    vector<uint32_t> outVersions;
+    vector<uint32_t> inVersions;
+};
+
+// 图快照文件的布局：96 字节头部之后依次是词表偏移、词表、单词查找表、CSR 的六个数组、可选的 PageRank
+// 和可选的 TF-IDF 权重（llm_1 的 PageRank 以它作随机跳转分布），
+// 每段从 8 字节对齐处开始，映射后可以直接当数组使用。各段的位置只由头部里的计数决定，写入和加载共用这份计算。
+// 数值按本机字节序保存，快照只在同一种机器之间共享
+struct SnapshotLayout {
+    static constexpr char kMagic[8] = {'W', 'G', 'S', 'N', 'A', 'P', 'S', 'H'};
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kHasPageRank = 1;
+    // PageRank 段是按 TF-IDF 随机跳转算出的（llm_1），没有这一位表示均匀随机跳转（llm）。
+    // 两个程序只使用与自己算法一致的 PageRank 段，另一种直接忽略、之后重新计算
+    static constexpr uint32_t kTfidfTeleport = 2;
+    static constexpr uint32_t kHasTfidf = 4;
+    static constexpr size_t kHeaderBytes = 96;
+
+    // 头部字段（按顺序）：魔数、版本、标志、节点数、边数、词表字节数、查找表槽位数、最大边权、文件总长，
+    // 以及计算 PageRank 段时的阻尼系数、收敛容差与迭代轮数（增量刷新要用同样的参数接着算）
+    uint32_t flags = 0;
+    uint64_t vertices = 0;
+    uint64_t edges = 0;
+    uint64_t vocabBytes = 0;
+    uint64_t indexSlots = 0;
+    int32_t maxWeight = 0;
+    uint64_t fileBytes = 0;
+    double damping = 0.0;
+    double tolerance = 0.0;
+    int32_t iterations = 0;
+
+    // 各段在文件中的起始位置，由 place() 计算
+    uint64_t wordOffsets = 0;
+    uint64_t vocab = 0;
+    uint64_t index = 0;
+    uint64_t offsets = 0;
+    uint64_t targets = 0;
+    uint64_t weights = 0;
+    uint64_t inOffsets = 0;
+    uint64_t inSources = 0;
+    uint64_t inWeights = 0;
+    uint64_t pageRank = 0;
+    uint64_t tfidf = 0;
+
+    static bool matches(const char* data, size_t size) {
+        return size >= sizeof(kMagic) && memcmp(data, kMagic, sizeof(kMagic)) == 0;
+    }
+
+    static uint64_t padding(uint64_t bytes) {
+        return (8 - bytes % 8) % 8;
+    }
+
+    bool hasPageRank() const {
+        return (flags & kHasPageRank) != 0u;
+    }
+
+    bool tfidfTeleport() const {
+        return (flags & kTfidfTeleport) != 0u;
+    }
+
+    bool hasTfidf() const {
+        return (flags & kHasTfidf) != 0u;
+    }
+
+    void place() {
+        uint64_t pos = kHeaderBytes;
+        auto section = [&pos](uint64_t bytes) {
+            uint64_t start = pos;
+            pos += bytes + padding(bytes);
+            return start;
+        };
+        wordOffsets = section((vertices + 1) * sizeof(uint64_t));
+        vocab = section(vocabBytes);
+        index = section(indexSlots * sizeof(uint32_t));
+        offsets = section((vertices + 1) * sizeof(uint64_t));
+        targets = section(edges * sizeof(uint32_t));
+        weights = section(edges * sizeof(int));
+        inOffsets = section((vertices + 1) * sizeof(uint64_t));
+        inSources = section(edges * sizeof(uint32_t));
+        inWeights = section(edges * sizeof(int));
+        pageRank = section(hasPageRank() ? vertices * sizeof(double) : 0);
+        tfidf = section(hasTfidf() ? vertices * sizeof(double) : 0);
+        fileBytes = pos;
+    }
+
+    string header() const {
+        string bytes(kHeaderBytes, '\0');
+        memcpy(&bytes[0], kMagic, sizeof(kMagic));
+        memcpy(&bytes[8], &kVersion, sizeof(kVersion));
+        memcpy(&bytes[12], &flags, sizeof(flags));
+        memcpy(&bytes[16], &vertices, sizeof(vertices));
+        memcpy(&bytes[24], &edges, sizeof(edges));
+        memcpy(&bytes[32], &vocabBytes, sizeof(vocabBytes));
+        memcpy(&bytes[40], &indexSlots, sizeof(indexSlots));
+        memcpy(&bytes[48], &maxWeight, sizeof(maxWeight));
+        memcpy(&bytes[56], &fileBytes, sizeof(fileBytes));
+        memcpy(&bytes[64], &damping, sizeof(damping));
+        memcpy(&bytes[72], &tolerance, sizeof(tolerance));
+        memcpy(&bytes[80], &iterations, sizeof(iterations));
+        return bytes;
+    }
+
+    // 解析头部并计算各段位置。魔数或版本不符、计数与文件长度对不上时返回 false
+    bool parse(const char* data, size_t size) {
+        if (size < kHeaderBytes || !matches(data, size)) return false;
+        uint32_t version = 0;
+        uint64_t storedBytes = 0;
+        memcpy(&version, data + 8, sizeof(version));
+        memcpy(&flags, data + 12, sizeof(flags));
+        memcpy(&vertices, data + 16, sizeof(vertices));
+        memcpy(&edges, data + 24, sizeof(edges));
+        memcpy(&vocabBytes, data + 32, sizeof(vocabBytes));
+        memcpy(&indexSlots, data + 40, sizeof(indexSlots));
+        memcpy(&maxWeight, data + 48, sizeof(maxWeight));
+        memcpy(&storedBytes, data + 56, sizeof(storedBytes));
+        memcpy(&damping, data + 64, sizeof(damping));
+        memcpy(&tolerance, data + 72, sizeof(tolerance));
+        memcpy(&iterations, data + 80, sizeof(iterations));
+        // 先排除大到会让 place() 溢出的计数
+        if (version != kVersion || vertices >= UINT32_MAX || edges > size || vocabBytes > size || indexSlots > size) {
+            return false;
+        }
+        // 参数不合理的 PageRank 段当作不存在（段的位置仍按标志计算）
+        place();
+        if (!(damping > 0.0 && damping < 1.0)) flags &= ~kHasPageRank;
+        return fileBytes == storedBytes && fileBytes == size;
+    }
+};
+
+class Graph {
+private:
+    // 从快照加载时持有文件映射；words 与 csr 可能直接指向映射的页面，所以它最先构造、最后析构
+    shared_ptr<MappedFile> snapshot;
+    WordInterner words;
+    // 上次冻结之后新增的边（按编号对计数），冻结时并入 CSR
+    mutable unordered_map<uint64_t, int> pendingEdges;
+    mutable CsrGraph csr;
+    vector<double> pageRank;
+    PageRankStats pageRankStats;
+    // 上次计算 PageRank 所用的参数（写入快照），以及之后图是否有变化
+    PageRankOptions rankOptions;
+    bool rankStale = false;
+    // 惰性/后台 PageRank：lazyRank 打开后 getPageRank 在没有结果或结果过期时按 lazyRankOptions 重新计算；
+    // startPageRank 在 rankWorker 线程里计算，rankRunning 在计算结束时清零；
+    // rankCancel 让正在进行的计算在本轮迭代结束后放弃（析构时设置，退出程序不必等它算完）
+    bool lazyRank = false;
+    PageRankOptions lazyRankOptions;
+    mutable thread rankWorker;
+    atomic<bool> rankRunning{false};
+    atomic<bool> rankCancel{false};
+    BridgeCache bridgeCache;
+    // 点对点最短路径的工作区，在查询之间复用；有地标表时改用 ALT 搜索
+    BidirectionalDijkstra<> pathSearch;
+    LandmarkIndex landmarks;
+    LandmarkAStar<> landmarkSearch;
+    YenKShortestPaths<> kPathSearch;
+    // 加权游走的别名表随 CSR 一起作废；单次 randomWalk 复用同一个工作区
+    mutable AliasTables walkTables;
+    WalkScratch walkScratch;
+    unique_ptr<WalkSink> walkSink = make_unique<TruncatingFileWalkSink>();
+    vector<double> tfidfScores; // 新增：存储每个单词的TF-IDF值（按单词编号）
+
+    // 新增：计算TF-IDF值的辅助函数
+    void calculateTFIDF() {
+        const auto& g = getCsr();
+        const size_t V = g.vertexCount();
+        vector<int> wordFreq(V, 0);   // 词频(TF)
+        vector<int> wordInDocs(V, 0); // 包含该词的文档数(IDF)
+        int totalWords = 0;
+        size_t sourceCount = 0;
+
+        // 计算词频，并统计每个词出现在多少个"上下文"中
+        // 这里我们将每个有出边的词的邻接关系视为一个"文档"
+        for (uint32_t src = 0; src < V; ++src) {
+            if (g.outDegree(src) == 0) continue;
+            sourceCount++;
+            wordFreq[src]++;
+            wordInDocs[src]++;
+            totalWords++;
+            for (uint64_t e = g.offsets[src]; e < g.offsets[src + 1]; ++e) {
+                wordFreq[g.targets[e]] += g.weights[e];
+                wordInDocs[g.targets[e]]++;
+                totalWords += g.weights[e];
+            }
+        }
+
+        // 计算TF-IDF
+        double totalDocs = sourceCount;
+        tfidfScores.assign(V, 0.0);
+        for (uint32_t word = 0; word < V; ++word) {
+            double tf = static_cast<double>(wordFreq[word]) / totalWords;
+            double idf = log(totalDocs / (1 + wordInDocs[word]));
+            tfidfScores[word] = tf * idf;
+        }
+
+        // 归一化TF-IDF值到[0.5, 2.0]范围
+        double maxTFIDF = 0.0;
+        double minTFIDF = numeric_limits<double>::max();
+        for (double score : tfidfScores) {
+            maxTFIDF = max(maxTFIDF, score);
+            minTFIDF = min(minTFIDF, score);
+        }
+
+        for (double& score : tfidfScores) {
+            if (maxTFIDF == minTFIDF) {
+                score = 1.0;  // 如果所有值都相同，设为1.0
+            } else {
+                // 将值映射到[0.5, 2.0]范围
+                score = 0.5 + 1.5 * (score - minTFIDF) / (maxTFIDF - minTFIDF);
+            }
+        }
+    }
+
+    // 把 pendingEdges 合并进 CSR；图未变化时什么都不做
+    void ensureFrozen() const {
+        if (csr.vertexCount() == words.size() && pendingEdges.empty()) return;
+        rebuildCsr();
+    }
+
+    // 重建 CSR：旧的 CSR 边与新增边一起按 (src, dest) 排序后写回
+    void rebuildCsr() const {
+        const size_t V = words.size();
+        vector<pair<uint64_t, int>> edges;
+        edges.reserve(csr.edgeCount() + pendingEdges.size());
+        for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+            for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+                edges.emplace_back(edgeKey(u, csr.targets[e]), csr.weights[e]);
+            }
+        }
+        for (const auto& [key, count] : pendingEdges) {
+            edges.emplace_back(key, count);
+        }
+        pendingEdges.clear();
+        sort(edges.begin(), edges.end());
+
+        // 先在普通 vector 里建好各数组，再交给 CSR（旧 CSR 可能直接指向快照文件，不能原地修改）
+        vector<uint64_t> offsets(V + 1, 0);
+        vector<uint32_t> targets;
+        vector<int> weights;
+        targets.reserve(edges.size());
+        weights.reserve(edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            auto src = static_cast<uint32_t>(edges[i].first >> 32);
+            auto dest = static_cast<uint32_t>(edges[i].first);
+            // 同一条边可能同时出现在旧 CSR 和 pendingEdges 中，合并计数
+            if (i > 0 && edges[i - 1].first == edges[i].first) {
+                weights.back() += edges[i].second;
+                continue;
+            }
+            offsets[src + 1]++;
+            targets.push_back(dest);
+            weights.push_back(edges[i].second);
+        }
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        // 计数排序构建反向索引；按源点升序遍历，每个目标的来源列表自然有序
+        vector<uint64_t> inOffsets(V + 1, 0);
+        for (uint32_t dest : targets) {
+            inOffsets[dest + 1]++;
+        }
+        partial_sum(inOffsets.begin(), inOffsets.end(), inOffsets.begin());
+        vector<uint32_t> inSources(targets.size());
+        vector<int> inWeights(targets.size());
+        vector<uint64_t> cursor(inOffsets.begin(), inOffsets.end() - 1);
+        for (uint32_t src = 0; src < V; ++src) {
+            for (uint64_t e = offsets[src]; e < offsets[src + 1]; ++e) {
+                uint64_t slot = cursor[targets[e]]++;
+                inSources[slot] = src;
+                inWeights[slot] = weights[e];
+            }
+        }
+
+        CsrGraph built;
+        if (!weights.empty()) {
+            built.maxWeight = *max_element(weights.begin(), weights.end());
+        }
+        built.offsets = move(offsets);
+        built.targets = move(targets);
+        built.weights = move(weights);
+        built.inOffsets = move(inOffsets);
+        built.inSources = move(inSources);
+        built.inWeights = move(inWeights);
+        csr = move(built);
+        walkTables = AliasTables();
+    }
+
+    // 按"入边数 + 1"的累计量把节点切成 parts 段连续区间，返回 parts + 1 个边界，
+    // 使每个线程分到的拉取工作量大致相同
+    static vector<uint32_t> partitionVertices(const CsrGraph& g, unsigned parts) {
+        const auto V = static_cast<uint32_t>(g.vertexCount());
+        const double total = static_cast<double>(g.edgeCount()) + V;
+        vector<uint32_t> bounds(parts + 1, V);
+        bounds[0] = 0;
+        for (unsigned p = 1; p < parts; ++p) {
+            double goal = total * p / parts;
+            // inOffsets[v] + v 随 v 单调递增，二分查找第一个达到目标的位置
+            uint32_t lo = bounds[p - 1];
+            uint32_t hi = V;
+            while (lo < hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (static_cast<double>(g.inOffsets[mid] + mid) < goal) lo = mid + 1; else hi = mid;
+            }
+            bounds[p] = lo;
+        }
+        return bounds;
+    }
+
+    // 把 PR 向量归一化到总和为 1
+    static void normalizeRanks(vector<double>& pr) {
+        double total = accumulate(pr.begin(), pr.end(), 0.0);
+        if (total <= 0.0) return;
+        for (double& value : pr) value /= total;
+    }
+
+    // 对连续三轮的结果 x0, x1, x2 逐分量做 Aitken Δ² 外推，结果写回 x2；
+    // 分母过小或外推值不为正的分量保持 x2 不变，最后重新归一化
+    static void aitkenExtrapolate(const vector<double>& x0, const vector<double>& x1, vector<double>& x2) {
+        for (size_t v = 0; v < x2.size(); ++v) {
+            double delta = x2[v] - x1[v];
+            double denom = delta - (x1[v] - x0[v]);
+            if (fabs(denom) < 1e-300) continue;
+            double extrapolated = x2[v] - delta * delta / denom;
+            if (extrapolated > 0.0 && isfinite(extrapolated)) x2[v] = extrapolated;
+        }
+        normalizeRanks(x2);
+    }
+
+public:
+    ~Graph() {
+        rankCancel.store(true, memory_order_relaxed);
+        waitPageRank();
+    }
+
+    void addEdge(const string& src, const string& dest) {
+        waitPageRank();
+        addEdge(words.intern(src), words.intern(dest));
+    }
+
+    uint32_t addWord(string_view word) {
+        waitPageRank();
+        return words.intern(word);
+    }
+
+    // 图的任何修改都先等后台的 PageRank 算完，再把结果标记为过期
+    void addEdge(uint32_t src, uint32_t dest, int count = 1) {
+        waitPageRank();
+        pendingEdges[edgeKey(src, dest)] += count;
+        bridgeCache.touch(src, dest);
+        // 新边可能让距离变短，旧地标表给出的下界不再可靠
+        if (!landmarks.empty()) landmarks.clear();
+        if (!pageRank.empty()) rankStale = true;
+    }
+
+    const CsrGraph& getCsr() const {
+        ensureFrozen();
+        return csr;
+    }
+
+    size_t vertexCount() const {
+        return words.size();
+    }
+
+    uint32_t findWord(string_view word) const {
+        return words.find(word);
+    }
+
+    string wordOf(uint32_t id) const {
+        return string(words.word(id));
+    }
+
+    // 与 wordOf 相同，但不复制字符串；驻留表只增不删，返回的视图一直有效
+    string_view wordView(uint32_t id) const {
+        return words.word(id);
+    }
+
+    // 桥接词查询：word1 的出邻居与 word2 的入邻居两个有序列表求交，结果按编号升序追加到 out。
+    // 图已冻结时这是只读操作，可以多线程共享；调用方复用 out 即可避免分配
+    void bridgeIds(uint32_t word1, uint32_t word2, vector<uint32_t>& out) const {
+        const auto& g = getCsr();
+        intersectSorted(g.targets.data() + g.offsets[word1], g.outDegree(word1),
+                        g.inSources.data() + g.inOffsets[word2], g.inDegree(word2), out);
+    }
+
+    // 桥接词查询：单词不存在或没有桥接词时只返回状态，由调用方决定是否需要生成提示信息
+    BridgeResult getBridgeWords(string_view word1, string_view word2) {
+        uint32_t id1 = words.find(word1);
+        uint32_t id2 = words.find(word2);
+        if (id1 == WordInterner::npos || id2 == WordInterner::npos) {
+            if (id1 == id2) return {BridgeStatus::MissingBoth};
+            return {id1 == WordInterner::npos ? BridgeStatus::MissingWord1 : BridgeStatus::MissingWord2};
+        }
+        return getBridgeWords(id1, id2);
+    }
+
+    BridgeResult getBridgeWords(uint32_t word1, uint32_t word2) {
+        return getBridgeWords(word1, word2, bridgeCache);
+    }
+
+    // 同上，但结果缓存在调用方提供的 cache 里：多线程批量查询时每个线程各用一个缓存。
+    // 这样的缓存收不到 addEdge 的失效通知，只能在图不变的期间使用
+    BridgeResult getBridgeWords(uint32_t word1, uint32_t word2, BridgeCache& cache) const {
+        const vector<uint32_t>* mids = cache.find(word1, word2);
+        if (mids == nullptr) {
+            vector<uint32_t> found;
+            bridgeIds(word1, word2, found);
+            mids = &cache.insert(word1, word2, move(found));
+        }
+        if (mids->empty()) return {BridgeStatus::NoBridge};
+        return {BridgeStatus::Found, mids->data(), mids->size()};
+    }
+
+    vector<string> shortestPath(const string& src, const string& dest) {
+        uint32_t s = words.find(src);
+        uint32_t t = words.find(dest);
+        vector<string> path;
+        if (s == WordInterner::npos || t == WordInterner::npos) return path;
+
+        vector<uint32_t> ids;
+        if (landmarks.empty()) {
+            ids = pathSearch.search(getCsr(), s, t);
+        } else {
+            ids = landmarkSearch.search(getCsr(), landmarks, s, t);
+        }
+        for (uint32_t id : ids) {
+            path.push_back(wordOf(id));
+        }
+        return path;
+    }
+
+    // 前 k 条无环最短路径，按长度升序（长度相同时按发现顺序），任一单词不在图中时返回空
+    vector<RankedPath> kShortestPaths(const string& src, const string& dest, size_t k) {
+        uint32_t s = words.find(src);
+        uint32_t t = words.find(dest);
+        if (s == WordInterner::npos || t == WordInterner::npos) return {};
+        return kPathSearch.search(getCsr(), s, t, k);
+    }
+
+    // ALT 预处理：选 count 个地标并求出到它们的正反向距离，之后的 shortestPath 改用 A*。
+    // 之后再 addEdge 会使地标表作废，回到双向 Dijkstra
+    void buildLandmarks(unsigned count) {
+        landmarks.build(getCsr(), count);
+    }
+
+    size_t landmarkCount() const {
+        return landmarks.size();
+    }
+
+    unsigned requestedLandmarkCount() const {
+        return landmarks.requestedSize();
+    }
+
+    // 地标表与图指纹一起保存，重启后可以直接加载；图变化后指纹不符，加载失败
+    bool saveLandmarks(const string& path) const {
+        return landmarks.save(path, csrFingerprint(getCsr()));
+    }
+
+    bool loadLandmarks(const string& path) {
+        const auto& g = getCsr();
+        return landmarks.load(path, csrFingerprint(g), g.vertexCount());
+    }
+
+    // 把词表、CSR 和 PageRank（已经算过且之后图没有变化时，连同它所用的 TF-IDF 权重）写成快照，
+    // 之后 loadSnapshot 可以直接映射使用
+    bool saveSnapshot(const string& path) const {
+        waitPageRank();  // 后台计算写完 pageRank 之后再读
+        const auto& g = getCsr();
+        const size_t V = words.size();
+        vector<uint64_t> wordOffsets(V + 1, 0);
+        for (uint32_t id = 0; id < V; ++id) {
+            wordOffsets[id + 1] = wordOffsets[id] + words.word(id).size();
+        }
+        vector<uint32_t> index = words.lookupTable();
+
+        SnapshotLayout layout;
+        if (pageRank.size() == V && !rankStale) {
+            layout.flags = SnapshotLayout::kHasPageRank | SnapshotLayout::kTfidfTeleport;
+            if (tfidfScores.size() == V) layout.flags |= SnapshotLayout::kHasTfidf;
+        }
+        layout.vertices = V;
+        layout.edges = g.edgeCount();
+        layout.vocabBytes = wordOffsets[V];
+        layout.indexSlots = index.size();
+        layout.maxWeight = g.maxWeight;
+        layout.damping = rankOptions.damping;
+        layout.tolerance = rankOptions.tolerance;
+        layout.iterations = pageRankStats.iterations;
+        layout.place();
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+        const char zeros[8] = {};
+        auto section = [&](const void* data, uint64_t bytes) {
+            out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+            out.write(zeros, static_cast<streamsize>(SnapshotLayout::padding(bytes)));
+        };
+        out << layout.header();
+        section(wordOffsets.data(), (V + 1) * sizeof(uint64_t));
+        for (uint32_t id = 0; id < V; ++id) {
+            out << words.word(id);
+        }
+        out.write(zeros, static_cast<streamsize>(SnapshotLayout::padding(layout.vocabBytes)));
+        section(index.data(), index.size() * sizeof(uint32_t));
+        section(g.offsets.data(), (V + 1) * sizeof(uint64_t));
+        section(g.targets.data(), g.edgeCount() * sizeof(uint32_t));
+        section(g.weights.data(), g.edgeCount() * sizeof(int));
+        section(g.inOffsets.data(), (V + 1) * sizeof(uint64_t));
+        section(g.inSources.data(), g.edgeCount() * sizeof(uint32_t));
+        section(g.inWeights.data(), g.edgeCount() * sizeof(int));
+        if (layout.hasPageRank()) section(pageRank.data(), V * sizeof(double));
+        if (layout.hasTfidf()) section(tfidfScores.data(), V * sizeof(double));
+        return static_cast<bool>(out);
+    }
+
+    // 以只读方式映射快照：词表、查找表与 CSR 直接使用映射的页面，不复制也不重建，
+    // 同一主机上的多个进程共享同一份页缓存；只有 PageRank 复制到堆上（之后可能被重新计算）。
+    // 之后仍可 addEdge，新边会在下次冻结时与映射的 CSR 合并成新的 CSR。
+    // 只能在空图上调用；文件不是快照或内容不一致时返回 false，图保持为空
+    bool loadSnapshot(const string& path) {
+        if (words.size() != 0 || !pendingEdges.empty()) return false;
+        auto file = make_shared<MappedFile>(path);
+        SnapshotLayout layout;
+        if (!file->isOpen() || !layout.parse(file->data(), file->size())) return false;
+        const char* base = file->data();
+        const uint64_t V = layout.vertices;
+        const uint64_t E = layout.edges;
+        const auto* wordOffsets = reinterpret_cast<const uint64_t*>(base + layout.wordOffsets);
+        const auto* index = reinterpret_cast<const uint32_t*>(base + layout.index);
+        const auto* offsets = reinterpret_cast<const uint64_t*>(base + layout.offsets);
+        const auto* inOffsets = reinterpret_cast<const uint64_t*>(base + layout.inOffsets);
+        // 只做 O(1) 的一致性检查，逐项校验会抵消映射加载的好处
+        if (wordOffsets[0] != 0 || wordOffsets[V] != layout.vocabBytes || offsets[0] != 0 || offsets[V] != E ||
+            inOffsets[0] != 0 || inOffsets[V] != E || layout.indexSlots <= V ||
+            (layout.indexSlots & (layout.indexSlots - 1)) != 0) {
+            return false;
+        }
+        file->advise(MADV_RANDOM);
+
+        words.attach(base + layout.vocab, ReadOnlyArray<uint64_t>(wordOffsets, V + 1),
+                     ReadOnlyArray<uint32_t>(index, layout.indexSlots));
+        CsrGraph mapped;
+        mapped.offsets = ReadOnlyArray<uint64_t>(offsets, V + 1);
+        mapped.targets = ReadOnlyArray<uint32_t>(reinterpret_cast<const uint32_t*>(base + layout.targets), E);
+        mapped.weights = ReadOnlyArray<int>(reinterpret_cast<const int*>(base + layout.weights), E);
+        mapped.inOffsets = ReadOnlyArray<uint64_t>(inOffsets, V + 1);
+        mapped.inSources = ReadOnlyArray<uint32_t>(reinterpret_cast<const uint32_t*>(base + layout.inSources), E);
+        mapped.inWeights = ReadOnlyArray<int>(reinterpret_cast<const int*>(base + layout.inWeights), E);
+        mapped.maxWeight = layout.maxWeight;
+        csr = move(mapped);
+        walkTables = AliasTables();
+        // 均匀随机跳转的 PageRank（llm 写的快照）与这里的算法不同，不能直接使用
+        if (layout.hasPageRank() && layout.tfidfTeleport()) {
+            const auto* rank = reinterpret_cast<const double*>(base + layout.pageRank);
+            pageRank.assign(rank, rank + V);
+            rankOptions.damping = layout.damping;
+            rankOptions.tolerance = layout.tolerance;
+            pageRankStats.iterations = layout.iterations;
+            if (layout.hasTfidf()) {
+                const auto* scores = reinterpret_cast<const double*>(base + layout.tfidf);
+                tfidfScores.assign(scores, scores + V);
+            }
+        }
+        snapshot = move(file);
+        return true;
+    }
+
+    bool hasPageRank() const {
+        waitPageRank();
+        return !pageRank.empty();
+    }
+
+    // 一次 Dijkstra 求出从 src 到所有节点的最短路径树；src 不在图中时返回空树
+    ShortestPathTree shortestPathTree(const string& src) const {
+        ShortestPathTree tree;
+        uint32_t s = words.find(src);
+        if (s != WordInterner::npos) {
+            runDijkstra(getCsr(), s, tree);
+        }
+        return tree;
+    }
+
+    void calculatePageRank(double damping = 0.85, int iterations = 100) {
+        PageRankOptions options;
+        options.damping = damping;
+        options.maxIterations = iterations;
+        calculatePageRank(options);
+    }
+
+    void calculatePageRank(const PageRankOptions& options) {
+        waitPageRank();
+        runPageRank(options);
+    }
+
+    // 在后台计算 PageRank 并立即返回，同时按 options 打开惰性模式（见 setLazyPageRank）。
+    // 之后查询 PageRank 或修改图都会先等这次计算结束
+    void startPageRank(const PageRankOptions& options) {
+        waitPageRank();
+        setLazyPageRank(options);
+        ensureFrozen();  // 先在当前线程冻结，后台线程与菜单上的查询都只读 CSR
+        rankRunning = true;
+        rankWorker = thread([this, options] {
+            runPageRank(options);
+            rankRunning.store(false, memory_order_release);
+        });
+    }
+
+    // 等待后台的 PageRank 计算结束；没有在计算时立即返回
+    void waitPageRank() const {
+        if (rankWorker.joinable()) rankWorker.join();
+    }
+
+    // 打开惰性模式：getPageRank 在还没有结果、或 addEdge 让结果过期时按 options 重新计算（有旧结果时热启动）
+    void setLazyPageRank(const PageRankOptions& options) {
+        lazyRank = true;
+        lazyRankOptions = options;
+    }
+
+    // 不等待后台计算，可以在菜单上随时显示
+    PageRankStatus pageRankStatus() const {
+        if (rankRunning.load(memory_order_acquire)) return PageRankStatus::Computing;
+        if (pageRank.empty()) return PageRankStatus::NotComputed;
+        return rankStale || pageRank.size() != words.size() ? PageRankStatus::Stale : PageRankStatus::Ready;
+    }
+
+    // 结果过期后 getPageRank 是否会自动重新计算（惰性模式）；否则要重新调用 calculatePageRank
+    bool refreshesPageRankOnQuery() const {
+        return lazyRank;
+    }
+
+private:
+    void runPageRank(const PageRankOptions& options) {
+        // Step 1: 所有单词都是图中的节点，并计算TF-IDF值
+        const auto& g = getCsr();
+        const size_t V = g.vertexCount();
+        // 计算TF-IDF值；图没有变化时沿用已有的（例如从快照载入的）结果
+        if (tfidfScores.size() != V || rankStale) calculateTFIDF();
+        
+        const double N = V;
+        const double damping = options.damping;
+        pageRankStats = PageRankStats();
+        if (V == 0) {
+            pageRank.clear();
+            return;
+        }
+
+        // 多线程时按入边数把节点切成连续区间，每个线程只写自己区间内的 share/newPr；
+        // 各种求和先按线程求部分和，再按线程序号顺序相加，结果不受调度影响。
+        // Gauss-Seidel 依赖逐节点的顺序更新，总是单线程运行。
+        const bool gaussSeidel = options.method == PageRankMethod::GaussSeidel;
+        const unsigned threads = gaussSeidel ? 1 : static_cast<unsigned>(min<size_t>(max(options.threads, 1u), V));
+        const vector<uint32_t> ranges = partitionVertices(g, threads);
+        
+        // Step 2: 使用基于TF-IDF的权重初始化PR值
+        vector<double> weightParts(threads);
+        runThreads(threads, [&](unsigned t) {
+            double part = 0.0;
+            for (uint32_t node = ranges[t]; node < ranges[t + 1]; ++node) {
+                part += tfidfScores[node];
+            }
+            weightParts[t] = part;
+        });
+        const double totalWeight = accumulate(weightParts.begin(), weightParts.end(), 0.0);
+        
+        // 使用归一化的TF-IDF值作为初始PR值；热启动时沿用上一次的结果，新节点取TF-IDF初值后整体归一化
+        vector<double> pr(V);
+        for (uint32_t node = 0; node < V; ++node) {
+            pr[node] = tfidfScores[node] / totalWeight;
+        }
+        if (options.warmStart && !pageRank.empty()) {
+            copy(pageRank.begin(), pageRank.begin() + static_cast<ptrdiff_t>(min(pageRank.size(), V)), pr.begin());
+            normalizeRanks(pr);
+        }
+        vector<double> newPr(V);
+        vector<double> share(V);  // 每个节点沿每条出边分出去的 PR(src)/出度
+        vector<double> older;     // Aitken 外推用到的前两轮结果
+        vector<double> old;
+    
+        // Step 3: 迭代计算，每轮 O(V+E)，残差低于阈值时提前结束
+        vector<double> danglingParts(threads);
+        vector<double> residualParts(threads);
+        Barrier barrier(threads);
+        bool stop = false;
+
+        runThreads(threads, [&](unsigned t) {
+            const uint32_t begin = ranges[t];
+            const uint32_t end = ranges[t + 1];
+            for (int i = 0; i < options.maxIterations; ++i) {
+                // 计算悬挂节点的PR总和（出度为0的节点），同时算出各节点的出边份额
+                double dangling = 0.0;
+                for (uint32_t node = begin; node < end; ++node) {
+                    size_t degree = g.outDegree(node);
+                    if (degree == 0) {
+                        dangling += pr[node];
+                        share[node] = 0.0;
+                    } else {
+                        share[node] = pr[node] / degree;
+                    }
+                }
+                danglingParts[t] = dangling;
+                barrier.arriveAndWait();
+                double danglingSum = accumulate(danglingParts.begin(), danglingParts.end(), 0.0);
+    
+                // 计算每个节点的新PR值：沿反向索引只拉取真正指向它的来源节点
+                double residual = 0.0;
+                for (uint32_t node = begin; node < end; ++node) {
+                    double sumIn = 0.0;
+                    for (uint64_t e = g.inOffsets[node]; e < g.inOffsets[node + 1]; ++e) {
+                        sumIn += share[g.inSources[e]];
+                    }
+
+                    // 使用TF-IDF权重影响随机跳转概率
+                    double randomJumpProb = (1.0 - damping) * tfidfScores[node] / totalWeight;
+                    double value = randomJumpProb + damping * (sumIn + danglingSum / N);
+                    residual += fabs(value - pr[node]);
+                    if (gaussSeidel) {
+                        // 原地更新，后面的节点立即用上新的出边份额和悬挂总和
+                        size_t degree = g.outDegree(node);
+                        if (degree == 0) {
+                            danglingSum += value - pr[node];
+                        } else {
+                            share[node] = value / degree;
+                        }
+                        pr[node] = value;
+                    } else {
+                        newPr[node] = value;
+                    }
+                }
+                residualParts[t] = residual;
+                barrier.arriveAndWait();
+
+                // 0 号线程负责交换缓冲区、外推和收敛判断，其余线程在屏障处等待
+                if (t == 0) {
+                    if (!gaussSeidel) {
+                        if (options.aitkenEvery > 0) {
+                            older.swap(old);
+                            old = pr;
+                        }
+                        swap(pr, newPr); // 更新PR值
+                        if (options.aitkenEvery > 0 && (i + 1) % options.aitkenEvery == 0 && older.size() == V) {
+                            aitkenExtrapolate(older, old, pr);
+                            older.clear();
+                            old.clear();
+                        }
+                    }
+                    double total = accumulate(residualParts.begin(), residualParts.end(), 0.0);
+                    pageRankStats.iterations = i + 1;
+                    pageRankStats.residuals.push_back(total);
+                    if (options.tolerance > 0.0 && total < options.tolerance) {
+                        pageRankStats.converged = true;
+                        stop = true;
+                    }
+                    if (rankCancel.load(memory_order_relaxed)) stop = true;
+                }
+                barrier.arriveAndWait();
+                if (stop) break;
+            }
+        });
+    
+        // 保存结果到成员变量；被取消的计算没有收敛，丢弃
+        if (rankCancel.load(memory_order_relaxed)) return;
+        pageRank = move(pr);
+        rankOptions = options;
+        rankStale = false;
+    }
+
+public:
+
+    double getPageRank(const string& word) {
+        waitPageRank();
+        if (lazyRank && (rankStale || pageRank.size() != words.size())) {
+            PageRankOptions options = lazyRankOptions;
+            options.warmStart = !pageRank.empty();
+            runPageRank(options);
+        }
+        uint32_t id = words.find(word);
+        return id < pageRank.size() ? pageRank[id] : 0.0;
+    }
+
+    // randomWalk 的结果交给 sink；传入空指针表示丢弃结果。默认每次截断重写 random_walk.txt
+    void setWalkSink(unique_ptr<WalkSink> sink) {
+        walkSink = sink ? move(sink) : make_unique<NullWalkSink>();
+    }
+
+    // 加权游走用的别名表，图变化后第一次调用时重建。多线程游走前应先调用一次，之后只读
+    const AliasTables& getWalkTables() const {
+        const auto& g = getCsr();
+        if (walkTables.threshold.size() != g.edgeCount()) {
+            walkTables.build(g);
+        }
+        return walkTables;
+    }
+
+    // 从 start 出发随机游走，走到没有出边的节点、即将重复走一条边或节点数达到 maxLength 时停止，
+    // 节点序列写入 scratch.path。weighted 为 true 时按共现次数加权选边（需要先调用 getWalkTables()）。
+    // node2vec 式的二阶游走（p、q 须为正数）：上一步从 prev 走到 current 后，候选 x 的偏置为 1/p（x 就是 prev）、
+    // 1（prev -> x 也是一条边）或 1/q（其余），再乘上一阶选边概率 π(x)。不物化每条边的转移表，
+    // 而是按 π 提议 x、以 偏置 / 包络 的概率接受（拒绝采样）；prev -> x 是否存在在 prev 的有序出边里二分查找。
+    // 每次提议 O(1)、判断 O(log 出度)，高频词的出度再大也不需要逐边计算。
+    // 包络只取 1 与 1/q 中的较大者：p 较小时返回边的偏置超出包络，超出的 (1/p - 包络) × π(prev) 单独作为一块
+    // 区域，每轮先按它占的面积比例直接选中 prev，这样小 p 不会拉低其余候选的接受率。
+    // p = q = 1 时就是一阶游走，不做拒绝采样
+    void biasedWalk(uint32_t start, double p, double q, bool weighted, SplitMix64& rng, WalkScratch& scratch,
+                    size_t maxLength = SIZE_MAX) const {
+        const auto& g = getCsr();
+        const double returnBias = 1.0 / p;
+        const double outBias = 1.0 / q;
+        const double envelope = max(1.0, outBias);
+        const bool firstOrder = returnBias == 1.0 && outBias == 1.0;
+        scratch.visited.clear();
+        scratch.path.clear();
+        scratch.path.push_back(start);
+        uint32_t previous = WordInterner::npos;
+        uint32_t current = start;
+        while (scratch.path.size() < maxLength) {
+            size_t degree = g.outDegree(current);
+            if (degree == 0) break;
+            const uint64_t base = g.offsets[current];
+            double outlier = 0.0;
+            if (!firstOrder && returnBias > envelope && previous != WordInterner::npos) {
+                size_t back = g.findEdge(current, previous);
+                if (back != g.edgeCount()) {
+                    double backProbability = weighted ? g.weights[back] / walkTables.totals[current] : 1.0 / degree;
+                    outlier = (returnBias - envelope) * backProbability;
+                }
+            }
+            uint32_t next = 0;
+            while (true) {
+                if (outlier > 0.0 && rng.uniform() * (envelope + outlier) < outlier) {
+                    next = previous;
+                    break;
+                }
+                uint64_t pick = rng.below(degree);
+                if (weighted) {
+                    pick = walkTables.sample(base, pick, static_cast<uint32_t>(rng.next() >> 32));
+                }
+                next = g.targets[base + pick];
+                // 第一步还没有上一跳，直接按一阶分布
+                if (firstOrder || previous == WordInterner::npos) break;
+                double bias = outBias;
+                if (next == previous) bias = min(returnBias, envelope);
+                else if (g.findEdge(previous, next) != g.edgeCount()) bias = 1.0;
+                if (bias >= envelope || rng.uniform() * envelope < bias) break;
+            }
+            if (!scratch.visited.insert(edgeKey(current, next))) break;
+            previous = current;
+            current = next;
+            scratch.path.push_back(current);
+        }
+    }
+
+    string randomWalk(bool weighted = false) {
+        return biasedRandomWalk(1.0, 1.0, weighted);
+    }
+
+    // 从随机选取的、有出边的节点出发做一次 biasedWalk，结果交给游走 sink 并返回（单词之间以空格分隔）
+    string biasedRandomWalk(double p, double q, bool weighted = false) {
+        const auto& g = getCsr();
+        if (g.edgeCount() == 0) return "";
+        static random_device rd;
+        static SplitMix64 rng((static_cast<uint64_t>(rd()) << 32) | rd());
+        if (weighted) getWalkTables();
+        // 只在有出边的节点中均匀选起点（拒绝采样）：从只作为句尾出现的词出发只能得到一个词。
+        // 图里至少有一条边，循环一定会结束；多数节点都有出边时期望只需抽一两次
+        auto start = static_cast<uint32_t>(rng.below(g.vertexCount()));
+        while (g.outDegree(start) == 0) start = static_cast<uint32_t>(rng.below(g.vertexCount()));
+        biasedWalk(start, p, q, weighted, rng, walkScratch);
+
+        string result;
+        for (auto id : walkScratch.path) {
+            result += words.word(id);
+            result += ' ';
+        }
+        walkSink->write(result);
+        return result;
+    }
+};
+
+// 字母分类与小写折叠内核：一次处理 64 字节，返回"是 ASCII 字母"的位掩码（第 i 位对应第 i 个字节），
+// 并把每个字节的 c | 0x20 写入 folded。对字母而言这正是 tolower，非字母字节的折叠结果不会被使用。
+using ClassifyBlockFn = uint64_t (*)(const char* in, char* folded);
+
+inline uint64_t classifyBlockScalar(const char* in, char* folded) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) {
+        auto lower = static_cast<unsigned char>(in[i] | 0x20);
+        folded[i] = static_cast<char>(lower);
+        if (lower >= 'a' && lower <= 'z') { mask |= uint64_t{1} << i;
+}
+    }
+    return mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// SSE2 是 x86-64 的基线指令集：(c | 0x20) - 'a' 按无符号比较 <= 25 即为字母
+inline uint64_t classifyBlockSse2(const char* in, char* folded) {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i letterA = _mm_set1_epi8('a');
+    const __m128i span = _mm_set1_epi8(25);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lower = _mm_or_si128(bytes, caseBit);
+        __m128i offset = _mm_sub_epi8(lower, letterA);
+        __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(offset, span), offset);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(folded + i), lower);
+        mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(isAlpha))) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+inline uint64_t classifyBlockAvx2(const char* in, char* folded) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i letterA = _mm256_set1_epi8('a');
+    const __m256i span = _mm256_set1_epi8(25);
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i lower = _mm256_or_si256(bytes, caseBit);
+        __m256i offset = _mm256_sub_epi8(lower, letterA);
+        __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span), offset);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(folded + i), lower);
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(isAlpha))) << i;
+    }
+    return mask;
+}
+#endif
+
+// 运行时按 CPU 能力选择内核，非 x86 平台使用标量版本
+inline ClassifyBlockFn selectClassifyBlock() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return classifyBlockAvx2;
+#if defined(__SSE2__)
+    return classifyBlockSse2;
+#endif
+#endif
+    return classifyBlockScalar;
+}
+
+class TextProcessor {
+public:
+    // 逐个产出小写单词：非 ASCII 字母一律视为分隔符（与按 C locale 的 isalpha/tolower 逐字符处理一致）。
+    // 每次分类 64 字节得到字母位掩码，再用 ctz 在掩码里找单词边界；完全落在块内的单词
+    // 直接以指向折叠缓冲区的 string_view 交给回调，跨块的单词才拼接到 carry 中。
+    // 回调返回后视图即失效。
+    template <class OnWord>
+    static void forEachWord(const char* data, size_t size, OnWord&& onWord) {
+        static const ClassifyBlockFn classify = selectClassifyBlock();
+        alignas(64) char folded[64];
+        alignas(64) char tail[64];
+        string carry;
+
+        for (size_t i = 0; i < size; i += 64) {
+            const char* block = data + i;
+            size_t length = min<size_t>(64, size - i);
+            if (length < 64) {
+                // 末尾不足 64 字节时补 0（0 不是字母），掩码里多出来的位自然为 0
+                memcpy(tail, block, length);
+                memset(tail + length, 0, 64 - length);
+                block = tail;
+            }
+            uint64_t alpha = classify(block, folded);
+
+            unsigned pos = 0;
+            if (!carry.empty()) {
+                // 上一块结尾的单词延续到本块开头
+                unsigned run = ~alpha == 0 ? 64 : static_cast<unsigned>(__builtin_ctzll(~alpha));
+                carry.append(folded, run);
+                if (run == 64) continue;
+                onWord(string_view(carry));
+                carry.clear();
+                pos = run;
+            }
+            while (pos < 64) {
+                uint64_t rest = alpha & (~uint64_t{0} << pos);
+                if (rest == 0) break;
+                auto start = static_cast<unsigned>(__builtin_ctzll(rest));
+                uint64_t gaps = ~alpha & (~uint64_t{0} << start);
+                if (gaps == 0) {
+                    // 单词一直延伸到块尾，留给下一块继续
+                    carry.assign(folded + start, 64 - start);
+                    break;
+                }
+                auto end = static_cast<unsigned>(__builtin_ctzll(gaps));
+                onWord(string_view(folded + start, end - start));
+                pos = end;
+            }
+        }
+        if (!carry.empty()) onWord(string_view(carry));
+    }
+
+    // 以内存映射方式流式读取文件；文件无法打开时返回 false
+    template <class OnWord>
+    static bool forEachWord(const string& filename, OnWord&& onWord) {
+        MappedFile file(filename);
+        if (!file.isOpen()) return false;
+        forEachWord(file.data(), file.size(), onWord);
+        return true;
+    }
+
+    // 直接把相邻单词对写入图中，峰值内存只和词表大小有关，与语料大小无关。
+    // 语料按字节区间切成若干块并行分词，每个线程维护自己的词表和边计数；
+    // 块边界只落在单词之间，相邻块首尾单词组成的边在合并时补上。
+    // 按块顺序合并局部词表时编号仍按首次出现顺序分配，所以结果与串行构建完全相同。
+    static bool buildGraph(const string& filename, Graph& graph,
+                           unsigned threads = thread::hardware_concurrency()) {
+        MappedFile file(filename);
+        if (!file.isOpen()) return false;
+        // 快照文件（见 Graph::saveSnapshot）直接映射加载，不再分词
+        if (SnapshotLayout::matches(file.data(), file.size())) return graph.loadSnapshot(filename);
+        const char* data = file.data();
+        const size_t size = file.size();
+        // 每块至少 1 MiB，小文件不值得开线程
+        const size_t chunks = max<size_t>(1, min<size_t>(max(threads, 1u), size >> 20));
+
+        auto isLetter = [](char c) {
+            auto lower = static_cast<unsigned char>(c | 0x20);
+            return lower >= 'a' && lower <= 'z';
+        };
+        vector<size_t> bounds(chunks + 1, size);
+        bounds[0] = 0;
+        for (size_t i = 1; i < chunks; ++i) {
+            size_t pos = max(bounds[i - 1], size / chunks * i);
+            while (pos < size && isLetter(data[pos])) ++pos;
+            bounds[i] = pos;
+        }
+
+        struct Chunk {
+            WordInterner words;
+            unordered_map<uint64_t, int> edges;
+            uint32_t first = WordInterner::npos;
+            uint32_t last = WordInterner::npos;
+        };
+        vector<Chunk> parts(chunks);
+        runThreads(static_cast<unsigned>(chunks), [&](unsigned t) {
+            Chunk& part = parts[t];
+            forEachWord(data + bounds[t], bounds[t + 1] - bounds[t], [&](string_view word) {
+                uint32_t id = part.words.intern(word);
+                if (part.last != WordInterner::npos) part.edges[edgeKey(part.last, id)]++;
+                else part.first = id;
+                part.last = id;
+            });
+        });
+
+        uint32_t prev = WordInterner::npos;
+        vector<uint32_t> toGlobal;
+        for (auto& part : parts) {
+            if (part.first == WordInterner::npos) continue;
+            toGlobal.resize(part.words.size());
+            for (uint32_t id = 0; id < part.words.size(); ++id) {
+                toGlobal[id] = graph.addWord(part.words.word(id));
+            }
+            // 拼接：上一块的最后一个单词指向本块的第一个单词
+            if (prev != WordInterner::npos) graph.addEdge(prev, toGlobal[part.first]);
+            for (const auto& [key, count] : part.edges) {
+                graph.addEdge(toGlobal[key >> 32], toGlobal[static_cast<uint32_t>(key)], count);
+            }
+            prev = toGlobal[part.last];
+            part = Chunk();
+        }
+        return true;
+    }
+
+    static vector<string> processText(const string& filename) {
+        vector<string> words;
+        forEachWord(filename, [&](string_view word) { words.emplace_back(word); });
+        return words;
+    }
+};
+
+// DOT 渲染队列：后台最多 maxWorkers 个 dot 进程并发，提交后立即返回，不阻塞菜单；
+// wait() 等待已提交的任务全部完成，析构时也会等待
+class DotRenderer {
+public:
+    explicit DotRenderer(unsigned maxWorkers) : maxWorkers(max(maxWorkers, 1u)) {}
+
+    ~DotRenderer() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    DotRenderer(const DotRenderer&) = delete;
+    DotRenderer& operator=(const DotRenderer&) = delete;
+
+    // 一次渲染任务：先写入带序号的临时文件，渲染完再改名为最终文件名，
+    // 这样并发的任务不会互相覆盖半写的 .dot / .png
+    struct Job {
+        string dotFile;
+        string imageFile;
+        string stagedDot;
+        string stagedImage;
+        uint64_t seq = 0;
+    };
+
+    // 为 dotFile/imageFile 分配一组唯一的临时文件名，调用方把 DOT 写入 stagedDot 后再 submit
+    Job stage(const string& dotFile, const string& imageFile) {
+        uint64_t seq = nextSeq.fetch_add(1) + 1;
+        string suffix = "." + to_string(seq) + ".tmp";
+        return {dotFile, imageFile, dotFile + suffix, imageFile + suffix, seq};
+    }
+
+    void submit(Job job) {
+        {
+            lock_guard<mutex> lock(mtx);
+            jobs.push_back(move(job));
+            pending++;
+            // 按需增加工作线程，不超过上限
+            if (workers.size() < maxWorkers && workers.size() < pending) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+        wakeup.notify_one();
+    }
+
+    void wait() {
+        unique_lock<mutex> lock(mtx);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    void work() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wakeup.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+            Job job = move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            string cmd = "dot -Tpng \"" + job.stagedDot + "\" -o \"" + job.stagedImage + "\"";
+            bool rendered = system(cmd.c_str()) == 0;
+            lock.lock();
+            // 同一目标可能有多个任务先后完成，只让最新提交的那个生效；
+            // dot 不可用时仍保留 .dot 文件，和以前一样
+            uint64_t& latest = installed[job.imageFile];
+            if (job.seq > latest) {
+                latest = job.seq;
+                rename(job.stagedDot.c_str(), job.dotFile.c_str());
+                if (rendered) rename(job.stagedImage.c_str(), job.imageFile.c_str());
+                else remove(job.stagedImage.c_str());
+            } else {
+                remove(job.stagedDot.c_str());
+                remove(job.stagedImage.c_str());
+            }
+            if (--pending == 0) done.notify_all();
+        }
+    }
+
+    const unsigned maxWorkers;
+    mutex mtx;
+    condition_variable wakeup;
+    condition_variable done;
+    deque<Job> jobs;
+    vector<thread> workers;
+    unordered_map<string, uint64_t> installed;
+    atomic<uint64_t> nextSeq{0};
+    size_t pending = 0;
+    bool stopping = false;
+};
+
+// 程序内共用的渲染队列，进程退出前会等待所有图片渲染完
+DotRenderer& dotRenderer() {
+    static DotRenderer renderer(min(4u, max(thread::hardware_concurrency(), 1u)));
+    return renderer;
+}
+
+// 导出 DOT 文件，edgeColors 中的边（按 edgeKey 编码）用对应的颜色加粗标注
+void exportToDot(const Graph& graph, const string& filename,
+                 const unordered_map<uint64_t, string>& edgeColors) {
+    ofstream dotFile(filename);
+    dotFile << "digraph G {\n";
+    dotFile << "  rankdir=LR;\n";  // 设置从左到右的布局
+
+    const auto& csr = graph.getCsr();
+    for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+        const string src = graph.wordOf(u);
+        for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            dotFile << "  \"" << src << "\" -> \"" << graph.wordOf(csr.targets[e]) << "\" [";
+            // 如果边在要标注的路径上，则用该路径的颜色标注
+            auto color = edgeColors.find(edgeKey(u, csr.targets[e]));
+            if (color != edgeColors.end()) {
+                dotFile << "color=" << color->second << ", penwidth=2.0, ";
+            }
+            dotFile << "label=\"" << csr.weights[e] << "\"];\n";
+        }
+    }
+    dotFile << "}\n";
+    dotFile.close();
+}
+
+void exportToDot(const Graph& graph, const string& filename = "graph.dot", 
+                const vector<string>& highlightPath = vector<string>()) {
+    unordered_map<uint64_t, string> highlightEdges;
+    for (size_t i = 0; i + 1 < highlightPath.size(); ++i) {
+        highlightEdges.emplace(edgeKey(graph.findWord(highlightPath[i]), graph.findWord(highlightPath[i + 1])), "red");
+    }
+    exportToDot(graph, filename, highlightEdges);
+}
+
+// 把多条路径画在同一张图上，每条路径一种颜色；几条路径共用的边取排名靠前的那条的颜色
+void exportToDot(const Graph& graph, const string& filename, const vector<RankedPath>& paths) {
+    static const char* const palette[] = {"red", "blue", "darkgreen", "orange", "purple",
+                                          "brown", "magenta", "cyan4", "gold3", "gray40"};
+    unordered_map<uint64_t, string> edgeColors;
+    for (size_t p = paths.size(); p-- > 0;) {
+        const auto& vertices = paths[p].vertices;
+        for (size_t i = 0; i + 1 < vertices.size(); ++i) {
+            edgeColors[edgeKey(vertices[i], vertices[i + 1])] = palette[p % size(palette)];
+        }
+    }
+    exportToDot(graph, filename, edgeColors);
+}
+
+// 更新showDirectedGraph函数，添加导出选项
+void showDirectedGraph(const Graph& graph, bool exportImage = false) {
+    // 原有命令行展示逻辑
+    const auto& csr = graph.getCsr();
+    cout << "Directed Graph:\n";
+    for (uint32_t u = 0; u < csr.vertexCount(); ++u) {
+        // 只作为目标出现、没有出边的单词不单独成行
+        if (csr.outDegree(u) == 0) continue;
+        cout << graph.wordOf(u) << " -> ";
+        for (uint64_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            cout << graph.wordOf(csr.targets[e]) << "(" << csr.weights[e] << ") ";
+        }
+        cout << "\n";
+    }
+
+    // 导出为图像文件（可选功能）
+    if (exportImage) {
+        auto job = dotRenderer().stage("graph.dot", "graph.png");
+        exportToDot(graph, job.stagedDot);
+        dotRenderer().submit(move(job));
+        cout << "\nGraph image will be saved to graph.png\n";
+    }
+}
+
+string queryBridgeWords(Graph& graph, const string& word1, const string& word2) {
+    BridgeResult bridges = graph.getBridgeWords(word1, word2);
+    switch (bridges.status) {
+        case BridgeStatus::MissingBoth:
+            return "No \"" + word1 + "\" and \"" + word2 + "\" in the graph!";
+        case BridgeStatus::MissingWord1:
+            return "No \"" + word1 + "\" in the graph!";
+        case BridgeStatus::MissingWord2:
+            return "No \"" + word2 + "\" in the graph!";
+        case BridgeStatus::NoBridge:
+            return "No bridge words from \"" + word1 + "\" to \"" + word2 + "\"!";
+        case BridgeStatus::Found:
+            break;
+    }
+    
+    stringstream ss;
+    ss << "The bridge words from \"" << word1 << "\" to \"" << word2 << "\" are: ";
+    for (size_t i = 0; i < bridges.size(); ++i) {
+        string_view bridge = graph.wordView(bridges[i]);
+        if (i == bridges.size() - 1) {
+            ss << "and \"" << bridge << "\".";
+        } else if (i == bridges.size() - 2) {
+            ss << "\"" << bridge << "\" ";
+        } else {
+            ss << "\"" << bridge << "\", ";
+        }
+    }
+    return ss.str();
+}
+
+// 在相邻两个已知词之间随机插入一个桥接词；bridgesOf(id1, id2) 返回两词之间的桥接词（BridgeResult），
+// 由调用方决定查哪个缓存
+class TextRewriter {
+public:
+    template <class BridgesOf>
+    const string& rewrite(const Graph& graph, const string& input, SplitMix64& rng, BridgesOf&& bridgesOf) {
+        // 与 stringstream >> word 相同：按空白切分并转为小写
+        lowered.assign(input);
+        transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        tokens.clear();
+        ids.clear();
+        for (size_t pos = 0; pos < lowered.size();) {
+            while (pos < lowered.size() && isspace(static_cast<unsigned char>(lowered[pos])) != 0) ++pos;
+            size_t start = pos;
+            while (pos < lowered.size() && isspace(static_cast<unsigned char>(lowered[pos])) == 0) ++pos;
+            if (pos > start) {
+                tokens.emplace_back(lowered.data() + start, pos - start);
+                ids.push_back(graph.findWord(tokens.back()));
+            }
+        }
+
+        text.clear();
+        for (size_t k = 0; k < tokens.size(); ++k) {
+            if (k > 0) text += ' ';
+            text += tokens[k];
+            if (k + 1 == tokens.size() || ids[k] == WordInterner::npos || ids[k + 1] == WordInterner::npos) continue;
+            BridgeResult bridges = bridgesOf(ids[k], ids[k + 1]);
+            if (bridges.found()) {
+                text += ' ';
+                text += graph.wordView(bridges[rng.below(bridges.size())]);
+            }
+        }
+        return text;
+    }
+
+private:
+    string lowered;
+    vector<string_view> tokens;
+    vector<uint32_t> ids;
+    string text;
+};
+
+string generateNewText(Graph& graph, const string& input) {
+    random_device rd;
+    SplitMix64 rng((static_cast<uint64_t>(rd()) << 32) | rd());
+    // 交互查询走图自带的桥接词缓存，同一对词反复出现时不必重新求交
+    TextRewriter rewriter;
+    return rewriter.rewrite(graph, input, rng,
+                            [&](uint32_t word1, uint32_t word2) { return graph.getBridgeWords(word1, word2); });
+}
+
+string calcShortestPath(Graph& graph, const string& word1, const string& word2, bool renderImage = true) {
+    auto path = graph.shortestPath(word1, word2);
+    if (path.empty()) return "No path from " + word1 + " to " + word2 + "!";
+    
+    // 导出带有红色标注的路径图（只要文字结果时跳过渲染）
+    if (renderImage) {
+        auto job = dotRenderer().stage("graph.dot", "graph.png");
+        exportToDot(graph, job.stagedDot, path);
+        dotRenderer().submit(move(job));
+    }
+    
+    stringstream ss;
+    ss << "Shortest path: ";
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) ss << " -> ";
+        ss << path[i];
+    }
+    if (renderImage) {
+        ss << "\nGraph with highlighted path will be saved to graph.png";
+    }
+    return ss.str();
+}
+
+// 前 k 条无环最短路径，每条附上总权重；所有路径画在同一张图上，每条一种颜色
+string calcKShortestPaths(Graph& graph, const string& word1, const string& word2, size_t k,
+                        bool renderImage = true) {
+    auto paths = graph.kShortestPaths(word1, word2, k);
+    if (paths.empty()) return "No path from " + word1 + " to " + word2 + "!";
+
+    stringstream ss;
+    ss << "Top " << paths.size() << " shortest paths from " << word1 << " to " << word2 << ":";
+    for (size_t i = 0; i < paths.size(); ++i) {
+        ss << "\n" << i + 1 << ". (" << paths[i].length << ") ";
+        for (size_t j = 0; j < paths[i].vertices.size(); ++j) {
+            if (j > 0) ss << " -> ";
+            ss << graph.wordView(paths[i].vertices[j]);
+        }
+    }
+    if (renderImage) {
+        string dotFile = "paths_" + word1 + "_to_" + word2 + ".dot";
+        string imageFile = "paths_" + word1 + "_to_" + word2 + ".png";
+        auto job = dotRenderer().stage(dotFile, imageFile);
+        exportToDot(graph, job.stagedDot, paths);
+        dotRenderer().submit(move(job));
+        ss << "\nGraph with highlighted paths will be saved to " << imageFile;
+    }
+    return ss.str();
+}
+
+// 修改计算单源最短路径的函数：所有路径都画在同一张图上（即最短路径树），只渲染一次
+string calcShortestPathToAll(Graph& graph, const string& source, bool renderImage = true) {
+    if (graph.findWord(source) == WordInterner::npos) {
+        return "输入的单词 '" + source + "' 不在图中！";
+    }
+
+    // 一次单源搜索得到整棵最短路径树，每个目标的路径都从树上回溯得到
+    auto tree = graph.shortestPathTree(source);
+    string imageFile = "path_" + source + "_to_all.png";
+
+    stringstream result;
+    result << "从单词 '" << source << "' 到其他所有单词的最短路径：\n";
+    if (renderImage) {
+        unordered_map<uint64_t, string> treeEdges;
+        for (uint32_t id = 0; id < graph.vertexCount(); ++id) {
+            if (id != tree.source && tree.reachable(id)) {
+                treeEdges.emplace(edgeKey(tree.prev[id], id), "red");
+            }
+        }
+        string dotFile = "path_" + source + "_to_all.dot";
+        auto job = dotRenderer().stage(dotFile, imageFile);
+        exportToDot(graph, job.stagedDot, treeEdges);
+        dotRenderer().submit(move(job));
+        result << "(所有路径已标注在 " << imageFile << " 中)\n";
+    }
+
+    vector<pair<string, uint32_t>> destinations;
+    for (uint32_t id = 0; id < graph.vertexCount(); ++id) {
+        string dest = graph.wordOf(id);
+        if (dest != source) {
+            destinations.emplace_back(move(dest), id);
+        }
+    }
+    sort(destinations.begin(), destinations.end());
+
+    for (const auto& [dest, destId] : destinations) {
+        auto path = tree.pathTo(destId);
+        result << "\n到 '" << dest << "' 的最短路径: ";
+        if (path.empty()) {
+            result << "不存在路径";
+        } else {
+            for (size_t i = 0; i < path.size(); ++i) {
+                if (i > 0) result << " -> ";
+                result << graph.wordOf(path[i]);
+            }
+        }
+    }
+    
+    return result.str();
+}
+
+double calcPageRank(Graph& graph, const string& word) {
+    return graph.getPageRank(word);
+}
+
+// 菜单上显示的 PageRank 状态
+const char* pageRankStatusText(PageRankStatus status, bool refreshOnQuery) {
+    switch (status) {
+        case PageRankStatus::NotComputed:
+            return "not computed";
+        case PageRankStatus::Computing:
+            return "computing in background";
+        case PageRankStatus::Ready:
+            return "ready";
+        case PageRankStatus::Stale:
+            return refreshOnQuery ? "stale, recomputed on next query" : "stale";
+    }
+    return "";
+}
+
+string randomWalk(Graph& graph, bool weighted = false) {
+    return graph.randomWalk(weighted);
+}
+
+// 建图并计算 PageRank（参数与交互模式相同），写成快照；快照里的 PageRank 标明是 TF-IDF 随机跳转的版本
+int saveSnapshot(const string& corpus, const string& snapshotFile) {
+    Graph graph;
+    if (!TextProcessor::buildGraph(corpus, graph)) {
+        cerr << "Cannot open file: " << corpus << "\n";
+        return 1;
+    }
+    if (!graph.hasPageRank()) {
+        PageRankOptions rankOptions;
+        rankOptions.tolerance = 1e-10;
+        rankOptions.threads = max(thread::hardware_concurrency(), 1u);
+        graph.calculatePageRank(rankOptions);
+    }
+    if (!graph.saveSnapshot(snapshotFile)) {
+        cerr << "Cannot write file: " << snapshotFile << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// --self-test 的结果汇总：每项打印一行 PASS/FAIL，最后按失败项数决定退出码
+class SelfTestReport {
+public:
+    void check(const string& name, bool ok, const string& detail = "") {
+        cout << (ok ? "PASS  " : "FAIL  ") << name;
+        if (!detail.empty()) cout << "  (" << detail << ")";
+        cout << "\n";
+        if (!ok) failed++;
+    }
+
+    size_t failures() const { return failed; }
+
+private:
+    size_t failed = 0;
+};
+
+// 自检用的图：给了语料文件就用它，否则用固定种子生成一段词频偏斜的合成语料，结果可重复
+bool buildSelfTestGraph(const string& filename, Graph& graph) {
+    if (!filename.empty()) return TextProcessor::buildGraph(filename, graph);
+    SplitMix64 rng(0x5e1f7e57);
+    string previous;
+    for (int i = 0; i < 100000; ++i) {
+        string word = "w" + to_string(rng.below(rng.below(20000) + 1));
+        if (!previous.empty()) graph.addEdge(previous, word);
+        previous = move(word);
+    }
+    return true;
+}
+
+string readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+void writeFile(const string& path, const string& bytes) {
+    ofstream(path, ios::binary | ios::trunc).write(bytes.data(), static_cast<streamsize>(bytes.size()));
+}
+
+// 快照：保存后重新映射，词表、CSR 与 PageRank 都与原图一致；图不变时重算 PageRank 用的是快照里的
+// TF-IDF 权重；惰性模式下加边后的重算（TF-IDF 随之更新）与完整重算一致；
+// 没有 TF-IDF 随机跳转标志（llm 写的）的 PageRank 段不被采用
+void selfTestSnapshot(const string& filename, SelfTestReport& report) {
+    Graph graph;
+    buildSelfTestGraph(filename, graph);
+    PageRankOptions options;
+    options.tolerance = 1e-6;
+    options.maxIterations = 1000;
+    graph.calculatePageRank(options);
+    const string path = "selftest_snapshot.bin";
+    Graph loaded;
+    bool saved = graph.saveSnapshot(path) && loaded.loadSnapshot(path);
+
+    const auto& a = graph.getCsr();
+    const auto& b = loaded.getCsr();
+    const auto vertices = static_cast<uint32_t>(graph.vertexCount());
+    vector<double> original(vertices);
+    bool same = saved && loaded.vertexCount() == vertices && b.edgeCount() == a.edgeCount() &&
+                b.maxWeight == a.maxWeight && loaded.pageRankStatus() == PageRankStatus::Ready;
+    for (uint32_t id = 0; id < vertices; ++id) {
+        original[id] = graph.getPageRank(graph.wordOf(id));
+        same = same && loaded.wordView(id) == graph.wordView(id) && loaded.findWord(graph.wordView(id)) == id &&
+               b.offsets[id + 1] == a.offsets[id + 1] && b.inOffsets[id + 1] == a.inOffsets[id + 1] &&
+               loaded.getPageRank(graph.wordOf(id)) == original[id];
+    }
+    for (size_t e = 0; same && e < a.edgeCount(); ++e) {
+        same = b.targets[e] == a.targets[e] && b.weights[e] == a.weights[e] && b.inSources[e] == a.inSources[e] &&
+               b.inWeights[e] == a.inWeights[e];
+    }
+    report.check("snapshot round-trips words, CSR and PageRank", same);
+
+    // 图没有变化，重算时直接用快照里的 TF-IDF 权重，结果应与原图逐位相同
+    string bytes = readFile(path);
+    SnapshotLayout layout;
+    bool stored = saved && layout.parse(bytes.data(), bytes.size()) && layout.tfidfTeleport() && layout.hasTfidf();
+    loaded.calculatePageRank(options);
+    bool reused = stored;
+    for (uint32_t id = 0; reused && id < vertices; ++id) {
+        reused = loaded.getPageRank(graph.wordOf(id)) == original[id];
+    }
+
+    // 惰性模式：在载入的图上加边后查询，按同样的参数热启动重算，结果应与重新构建、同样加边后的图的
+    // 精确解一致（新建的图没有旧的 TF-IDF 权重可用，保证对照是按新图算的）
+    SplitMix64 rng(24);
+    Graph rebuilt;
+    buildSelfTestGraph(filename, rebuilt);
+    loaded.setLazyPageRank(options);
+    for (int i = 0; i < 5; ++i) {
+        auto src = static_cast<uint32_t>(rng.below(vertices));
+        auto dest = static_cast<uint32_t>(rng.below(vertices));
+        loaded.addEdge(src, dest);
+        rebuilt.addEdge(src, dest);
+    }
+    bool stale = loaded.pageRankStatus() == PageRankStatus::Stale;
+    PageRankOptions exact = options;
+    exact.tolerance = 1e-14;
+    rebuilt.calculatePageRank(exact);
+    double distance = 0.0;
+    for (uint32_t id = 0; id < vertices; ++id) {
+        distance += fabs(loaded.getPageRank(graph.wordOf(id)) - rebuilt.getPageRank(graph.wordOf(id)));
+    }
+    stringstream detail;
+    detail << (!saved ? "snapshot not reloaded" : stale ? "recomputed on query" : "rank not marked stale")
+           << ", L1 error " << scientific << setprecision(2) << distance;
+    report.check("lazy PageRank on a loaded snapshot matches a full recompute",
+                 saved && stale && distance <= 2.0 * options.tolerance / (1.0 - options.damping), detail.str());
+
+    // 把快照里的 TF-IDF 权重换成别的值后重新载入，重算的结果应随之改变，说明用的确实是这一段
+    bool changed = false;
+    if (stored) {
+        string altered = bytes;
+        for (uint64_t i = 0; i < layout.vertices; ++i) {
+            double score = 1.0 + static_cast<double>(i % 7);
+            memcpy(&altered[layout.tfidf + i * sizeof(double)], &score, sizeof(score));
+        }
+        writeFile(path, altered);
+        Graph other;
+        if (other.loadSnapshot(path)) {
+            other.calculatePageRank(options);
+            double difference = 0.0;
+            for (uint32_t id = 0; id < vertices; ++id) {
+                difference += fabs(other.getPageRank(other.wordOf(id)) - original[id]);
+            }
+            changed = difference > 1e-9;
+        }
+    }
+    report.check("PageRank recomputed from a snapshot uses its TF-IDF weights", reused && changed,
+                 !stored ? "no TF-IDF section" : !reused ? "result differs from the original" :
+                 !changed ? "stored weights ignored" : "");
+
+    // 去掉 TF-IDF 随机跳转标志（均匀随机跳转，llm 写的快照），PageRank 段应被忽略
+    bool ignored = false;
+    if (bytes.size() >= SnapshotLayout::kHeaderBytes) {
+        uint32_t flags = 0;
+        memcpy(&flags, &bytes[12], sizeof(flags));
+        flags &= ~SnapshotLayout::kTfidfTeleport;
+        memcpy(&bytes[12], &flags, sizeof(flags));
+        writeFile(path, bytes);
+        Graph other;
+        ignored = other.loadSnapshot(path) && other.vertexCount() == vertices && !other.hasPageRank();
+    }
+    report.check("PageRank computed with another teleport variant is ignored", ignored);
+    remove(path.c_str());
+}
+
+// 不指定语料时跑合成语料和仓库自带的几份小语料（需在仓库根目录下运行）
+int selfTest(vector<string> corpora) {
+    if (corpora.empty()) corpora = {"", "1.txt", "Easy_Test.txt", "Easy_Test_2.txt", "hard_text.txt"};
+    SelfTestReport report;
+    for (const auto& filename : corpora) {
+        cout << "== " << (filename.empty() ? "synthetic corpus" : filename) << "\n";
+        if (!filename.empty() && !ifstream(filename)) {
+            report.check("corpus is readable", false, "cannot open " + filename);
+            continue;
+        }
+        selfTestSnapshot(filename, report);
+    }
+    return report.failures() == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <filename> [--no-render] [--landmarks K]\n"
+             << "       " << argv[0] << " --save-snapshot <filename> <snapshot>\n"
+             << "       " << argv[0] << " --self-test [filename...]\n";
+        return 1;
+    }
+    if (string(argv[1]) == "--save-snapshot" && argc >= 4) return saveSnapshot(argv[2], argv[3]);
+    if (string(argv[1]) == "--self-test") return selfTest(vector<string>(argv + 2, argv + argc));
+
+    // 第一个非选项参数是语料文件，也可以是 --save-snapshot 生成的快照（llm 生成的快照也可以，
+    // 但其中的 PageRank 算法不同，会被忽略并重新计算）；
+    // --no-render 表示路径查询只输出文字，不调用 dot 生成图片；
+    // --landmarks K 为最短路径查询预处理 K 个地标（ALT），地标表保存在 <filename>.alt，下次启动直接加载
+    string filename;
+    bool renderImages = true;
+    unsigned landmarkCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--no-render") renderImages = false;
+        else if (arg == "--landmarks" && i + 1 < argc) landmarkCount = stoul(argv[++i]);
+        else if (filename.empty()) filename = arg;
+    }
+
+    Graph graph;
+    if (!TextProcessor::buildGraph(filename, graph)) {
+        cerr << "Cannot open file: " << filename << "\n";
+        return 1;
+    }
+
+    if (landmarkCount > 0) {
+        string landmarkFile = filename + ".alt";
+        // 按要求的地标数比较：图太小时实际选出的地标可能更少，不应因此每次启动都重建
+        if (!graph.loadLandmarks(landmarkFile) || graph.requestedLandmarkCount() != landmarkCount) {
+            graph.buildLandmarks(landmarkCount);
+            if (!graph.saveLandmarks(landmarkFile)) cerr << "Cannot write file: " << landmarkFile << "\n";
+        }
+    }
+
+    // PageRank 在后台线程计算，菜单立即可用；查询 PageRank 时如果还没算完就等它结束。
+    // 快照里已经带有 PageRank 时直接使用。之后图有变化时，下一次查询会按同样的参数重新计算
+    PageRankOptions rankOptions;
+    rankOptions.tolerance = 1e-10;  // 收敛即停止，不必固定跑满 100 轮
+    rankOptions.threads = max(thread::hardware_concurrency(), 1u);
+    if (graph.hasPageRank()) {
+        graph.setLazyPageRank(rankOptions);
+    } else {
+        graph.startPageRank(rankOptions);
+    }
+    // 交互模式下游走结果仍写入 random_walk.txt，但由后台线程完成，菜单不必等待文件 I/O
+    graph.setWalkSink(make_unique<AsyncWalkSink>(make_unique<TruncatingFileWalkSink>()));
+
+    while (true) {
+        cout << "\nOptions:\n"
+             << "1. Show directed graph\n"
+             << "2. Export graph to image (PNG)\n"
+             << "3. Query bridge words\n"
+             << "4. Generate new text\n"
+             << "5. Calculate shortest path\n"
+             << "6. Calculate PageRank (" << pageRankStatusText(graph.pageRankStatus(), graph.refreshesPageRankOnQuery()) << ")\n"
+             << "7. Random walk\n"
+             << "8. K shortest paths\n"
+             << "9. Exit\n"
+             << "Choice: ";
+
+        int choice;
+        cin >> choice;
+        cin.ignore();
+
+        switch (choice) {
+            case 1:
+                showDirectedGraph(graph);
+                break;
+            case 2:
+                showDirectedGraph(graph, true);  // 导出为图像
+                break;
+            case 3: {
+                string word1, word2;
+                cout << "Enter two words: ";
+                cin >> word1 >> word2;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                cout << queryBridgeWords(graph, word1, word2) << endl;
+                break;
+            }
+            case 4: {
+                string input;
+                cout << "Enter text: ";
+                getline(cin, input);
+                cout << generateNewText(graph, input) << endl;
+                break;
+            }
+            case 5: {
+                string word1, word2;
+                cout << "Enter one or two words: ";
+                cin >> word1;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                
+                // 检查是否有第二个单词输入
+                string line;
+                getline(cin, line);
+                stringstream ss(line);
+                if (ss >> word2) {
+                    // 如果输入了两个单词，计算它们之间的最短路径
+                    transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                    cout << calcShortestPath(graph, word1, word2, renderImages) << endl;
+                } else {
+                    // 如果只输入了一个单词，计算到所有其他单词的最短路径
+                    cout << calcShortestPathToAll(graph, word1, renderImages) << endl;
+                }
+                break;
+            }
+            case 6: {
+                string word;
+                cout << "Enter word: ";
+                cin >> word;
+                transform(word.begin(), word.end(), word.begin(), ::tolower);
+                if (graph.pageRankStatus() == PageRankStatus::Computing) {
+                    cout << "Waiting for the background PageRank computation..." << endl;
+                }
+                cout << "PageRank: " << fixed << setprecision(4) << calcPageRank(graph, word) << endl;
+                break;
+            }
+            case 7:
+                cout << "Random walk: " << randomWalk(graph) << endl;
+                break;
+            case 8: {
+                string word1;
+                string word2;
+                size_t k = 5;
+                cout << "Enter two words and k: ";
+                cin >> word1 >> word2 >> k;
+                transform(word1.begin(), word1.end(), word1.begin(), ::tolower);
+                transform(word2.begin(), word2.end(), word2.begin(), ::tolower);
+                cout << calcKShortestPaths(graph, word1, word2, k, renderImages) << endl;
+                break;
+            }
+            case 9:
+                return 0;
+            default:
+                cout << "Invalid choice\n";
+        }
+    }
 }
\ No newline at end of file